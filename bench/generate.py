@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Deterministic generator of FanC sources for the benchmarks.
+
+The same seed and options always give the same program. Programs are well typed in the language of hw3, and
+only use what the hw1, hw2 and hw3 scanners all accept, so one input runs through all three front ends.
+
+    generate.py --bytes 4000000 --mix id=4,string=1,comment=1,number=2 --depth 3 > big.fanc
+
+--mix weighs the kinds of statements: assignments between identifiers, prints of long strings, comment lines
+and arithmetic on numbers. --depth nests some statements in that many if and while blocks, and --statements
+sets how many statements a function has, so a large value gives the long function bodies the checker scopes.
+"""
+
+import argparse
+import random
+import sys
+
+MIX = {"id": 4, "string": 1, "comment": 1, "number": 2}
+
+WORDS = ["alpha", "beta", "gamma", "delta", "count", "total", "index", "value", "offset", "limit"]
+ESCAPES = ["\\n", "\\t", "\\\\", "\\\""]
+
+
+class Generator:
+    def __init__(self, seed, mix, depth, statements):
+        self.random = random.Random(seed)
+        self.kinds = list(mix)
+        self.weights = [mix[kind] for kind in self.kinds]
+        self.depth = depth
+        self.statements = statements
+        self.lines = []
+        self.tokens = 0
+        self.size = 0
+
+    def emit(self, indent, *tokens):
+        line = "    " * indent + " ".join(tokens)
+        self.lines.append(line)
+        self.tokens += len(tokens)
+        self.size += len(line) + 1
+
+    def name(self, locals_):
+        return self.random.choice(locals_)
+
+    def number(self):
+        return str(self.random.randrange(1, 100000))
+
+    def string(self):
+        parts = []
+        for _ in range(self.random.randrange(4, 16)):
+            parts.append(self.random.choice(WORDS))
+            if self.random.random() < 0.2:
+                parts.append(self.random.choice(ESCAPES))
+        return '"' + " ".join(parts) + '"'
+
+    def simple(self, indent, locals_, comments=True):
+        """A statement that declares nothing, so it can go in any block. A block needs one that is not a comment"""
+        weights = [0 if kind == "comment" and not comments else weight for kind, weight in zip(self.kinds, self.weights)]
+        kind = self.random.choices(self.kinds, weights)[0] if any(weights) else "id"
+        if kind == "id":
+            self.emit(indent, self.name(locals_), "=", self.name(locals_), "+", self.name(locals_), "*", "a", ";")
+        elif kind == "string":
+            self.emit(indent, "print", "(", self.string(), ")", ";")
+        elif kind == "comment":
+            self.emit(indent, "// " + " ".join(self.random.choice(WORDS) for _ in range(self.random.randrange(3, 12))))
+        else:
+            self.emit(indent, self.name(locals_), "=", self.number(), "*", self.number(), "-",
+                      str(self.random.randrange(256)) + "b", ";")
+
+    def nested(self, indent, locals_, depth):
+        keyword = self.random.choice(["if", "while"])
+        self.emit(indent, keyword, "(", self.name(locals_), "<", self.number(), ")", "{")
+        if depth > 1:
+            self.nested(indent + 1, locals_, depth - 1)
+        else:
+            self.simple(indent + 1, locals_, comments=False)
+        self.emit(indent, "}")
+
+    def function(self, index):
+        self.emit(0, "int", "f%d" % index, "(", "int", "a", ",", "byte", "b", ")", "{")
+        locals_ = ["a"]
+        for count in range(self.statements):
+            if count % 4 == 0:
+                local = "%s%d" % (self.random.choice(WORDS), count)
+                self.emit(1, "int", local, "=", self.name(locals_), "+", "b", ";")
+                locals_.append(local)
+            elif self.depth and self.random.random() < 0.1:
+                self.nested(1, locals_, self.depth)
+            else:
+                self.simple(1, locals_)
+        self.emit(1, "return", self.name(locals_), ";")
+        self.emit(0, "}")
+
+    def program(self, size):
+        functions = 0
+        while functions == 0 or self.size < size:
+            self.function(functions)
+            functions += 1
+        self.emit(0, "void", "main", "(", ")", "{")
+        self.emit(1, "printi", "(", "f0", "(", "1", ",", "2b", ")", ")", ";")
+        self.emit(0, "}")
+        return "\n".join(self.lines) + "\n"
+
+
+def parse_mix(text):
+    mix = {kind: 0 for kind in MIX}
+    for item in text.split(","):
+        kind, _, weight = item.partition("=")
+        if kind not in mix:
+            raise argparse.ArgumentTypeError("unknown kind %s" % kind)
+        mix[kind] = int(weight)
+    if not any(mix.values()):
+        raise argparse.ArgumentTypeError("the mix has no weights")
+    return mix
+
+
+def generate(size, seed=1, mix=None, depth=3, statements=50):
+    """returns the source and its number of tokens, comments included"""
+    generator = Generator(seed, mix or MIX, depth, statements)
+    source = generator.program(size)
+    return source, generator.tokens
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--bytes", type=int, default=1 << 20, help="size to grow the program to")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--mix", type=parse_mix, default=MIX, help="weights, e.g. id=4,string=1,comment=1,number=2")
+    parser.add_argument("--depth", type=int, default=3, help="nesting of the if and while blocks")
+    parser.add_argument("--statements", type=int, default=50, help="statements per function")
+    args = parser.parse_args()
+    source, tokens = generate(args.bytes, args.seed, args.mix, args.depth, args.statements)
+    sys.stdout.write(source)
+    print("%d bytes, %d tokens" % (len(source), tokens), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Runs the scanners and front ends over generated sources and writes the results as JSON.
+
+    run.py --build _build --output bench_output.txt [--flex] [--bytes N] [--repeat N] [--case NAME ...]
+           [--compare OTHER_BUILD]
+
+Each case runs a binary of the build over one generated input, --repeat times, and keeps the fastest run. A result
+has the input size, its tokens, the seconds, MB/s and tokens/s, and the peak resident memory of the fastest run.
+--compare runs every case on a second build too, such as one of an earlier commit, and adds its seconds and the
+speedup of the build over it. Both builds read the same input files and token stream.
+Without --flex the build has no flex scanner, so the flex cases are skipped and hw2 and hw3 parse the token
+stream hw1 --emit-tokens=binary writes. With --flex the report also has the size of the tables flex generated for
+the scanner, of both builds when comparing.
+"""
+
+import argparse
+import json
+import os
+import platform
+import re
+import subprocess
+import sys
+import tempfile
+import time
+
+GENERATE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "generate.py")
+
+# The inputs, by name: the options of generate.py
+INPUTS = {
+    "mixed": [],
+    "strings": ["--mix", "id=1,string=6,comment=1,number=1"],
+    "deep": ["--depth", "40"],
+    "long-bodies": ["--statements", "20000"],
+    "longer-bodies": ["--statements", "80000"],
+}
+
+
+def cases(flex):
+    """name, input, how the input is given (file, stdin, pipe or tokens) and the command. stdin redirects the
+    file, so only pipe makes a scanner stream its input"""
+    result = [
+        ("hw1-simd", "mixed", "file", ["hw1", "--lexer=simd", "--input", "{input}"]),
+        ("hw1-simd-stdin", "mixed", "stdin", ["hw1", "--lexer=simd"]),
+        ("hw1-simd-pipe", "mixed", "pipe", ["hw1", "--lexer=simd"]),
+        ("hw1-simd-strings", "strings", "file", ["hw1", "--lexer=simd", "--input", "{input}"]),
+        ("hw1-emit-tokens", "mixed", "file", ["hw1", "--emit-tokens=binary", "--input", "{input}"]),
+    ]
+    # --jobs at 2 and 4, and at every core of this machine, against hw1-simd for one job. hw1 runs no more jobs
+    # than there are cores, so larger counts are left out
+    cores = os.cpu_count() or 1
+    for jobs in sorted(jobs for jobs in {2, 4, cores} if 1 < jobs <= cores):
+        result.append(("hw1-jobs-%d" % jobs, "mixed", "file", ["hw1", "--jobs", str(jobs), "--input", "{input}"]))
+    if flex:
+        result += [
+            ("hw1-flex", "mixed", "file", ["hw1", "--input", "{input}"]),
+            ("hw1-flex-stdin", "mixed", "stdin", ["hw1"]),
+            ("hw1-flex-pipe", "mixed", "pipe", ["hw1"]),
+            ("hw1-flex-strings", "strings", "file", ["hw1", "--input", "{input}"]),
+            ("hw2-parse", "mixed", "stdin", ["hw2"]),
+            ("hw3-check", "mixed", "stdin", ["hw3"]),
+            ("hw3-check-long-bodies", "long-bodies", "stdin", ["hw3"]),
+        ]
+    result += [
+        ("hw2-parse-tokens", "mixed", "tokens", ["hw2", "--tokens", "{tokens}"]),
+        ("hw2-parse-deep", "deep", "tokens", ["hw2", "--tokens", "{tokens}"]),
+        ("hw3-check-tokens", "mixed", "tokens", ["hw3", "--tokens", "{tokens}"]),
+        ("hw3-check-deep", "deep", "tokens", ["hw3", "--tokens", "{tokens}"]),
+        ("hw3-check-long-bodies-tokens", "long-bodies", "tokens", ["hw3", "--tokens", "{tokens}"]),
+        # The same size in bodies four times as long: as fast per byte when a lookup does not grow with the scope
+        ("hw3-check-longer-bodies-tokens", "longer-bodies", "tokens", ["hw3", "--tokens", "{tokens}"]),
+    ]
+    # hw3 checks no more bodies at once than there are cores either
+    if cores >= 4:
+        result.append(("hw3-jobs-4", "mixed", "tokens", ["hw3", "--jobs", "4", "--tokens", "{tokens}"]))
+    return result
+
+
+def measure(command, stdin_path, pipe=False):
+    """runs command with its output thrown away, and stdin_path as its input if given, written into a pipe by cat
+    when pipe is set. Returns the seconds and the peak resident kilobytes"""
+    with open(stdin_path or os.devnull, "rb") as stdin, open(os.devnull, "wb") as devnull, \
+            tempfile.TemporaryFile() as stderr:
+        start = time.perf_counter()
+        feeder = subprocess.Popen(["cat"], stdin=stdin, stdout=subprocess.PIPE) if pipe else None
+        process = subprocess.Popen(command, stdin=feeder.stdout if pipe else stdin, stdout=devnull, stderr=stderr)
+        if feeder:
+            feeder.stdout.close()  # Leaves the read end to the command alone
+        _, status, usage = os.wait4(process.pid, 0)
+        seconds = time.perf_counter() - start
+        process.returncode = status
+        if feeder:
+            feeder.wait()
+        stderr.seek(0)
+        errors = stderr.read().decode(errors="replace")
+    if status != 0:
+        raise RuntimeError("%s exited with %d: %s" % (" ".join(command), status, errors.strip()))
+    return seconds, usage.ru_maxrss
+
+
+# The table arrays in a scanner generated by flex, e.g. "static const flex_int16_t yy_nxt[185] ="
+TABLE = re.compile(r"^static (?:yyconst |const )?(flex_u?int(?:8|16|32)_t|YY_CHAR) (yy_\w+)\[(\d+)\]", re.MULTILINE)
+ENTRY_BYTES = {"YY_CHAR": 1}
+
+
+def flex_tables(build):
+    """entries and bytes of each table of the flex scanner of build, and their total bytes, or None if the build
+    has no generated scanner"""
+    path = os.path.join(build, "scanner", "scanner.cpp")
+    if not os.path.exists(path):
+        return None
+    with open(path) as file:
+        source = file.read()
+    tables = {}
+    for kind, name, entries in TABLE.findall(source):
+        size = ENTRY_BYTES.get(kind) or int(re.search(r"\d+", kind).group()) // 8
+        tables[name] = {"entries": int(entries), "bytes": int(entries) * size}
+    return {"tables": tables, "total_bytes": sum(table["bytes"] for table in tables.values())}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--build", required=True, help="the build directory with hw1, hw2 and hw3")
+    parser.add_argument("--output", required=True, help="where to write the JSON results")
+    parser.add_argument("--flex", action="store_true", help="the build has the flex scanner")
+    parser.add_argument("--bytes", type=int, default=4 << 20, help="size of each generated input")
+    parser.add_argument("--repeat", type=int, default=3)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--case", action="append", help="run only these cases")
+    parser.add_argument("--compare", help="a second build to run the cases on, for the speedup over it")
+    args = parser.parse_args()
+
+    selected = [case for case in cases(args.flex) if not args.case or case[0] in args.case]
+    results = []
+    with tempfile.TemporaryDirectory() as directory:
+        inputs = {}
+        for name in sorted({case[1] for case in selected}):
+            # Generated in a child process: the peak RSS of a command counts the memory of the process that
+            # started it, so this one must never hold a whole input
+            path = os.path.join(directory, name + ".fanc")
+            with open(path, "w") as file:
+                generator = subprocess.run([sys.executable, GENERATE, "--bytes", str(args.bytes),
+                                            "--seed", str(args.seed)] + INPUTS[name],
+                                           stdout=file, stderr=subprocess.PIPE, check=True)
+            size, tokens = map(int, re.match(rb"(\d+) bytes, (\d+) tokens", generator.stderr).groups())
+            stream = os.path.join(directory, name + ".tok")
+            with open(stream, "wb") as file:
+                subprocess.run([os.path.join(args.build, "hw1"), "--emit-tokens=binary", "--input", path],
+                               stdout=file, check=True)
+            inputs[name] = (path, stream, size, tokens)
+
+        def fastest(build, command, mode, path, stream):
+            command = [os.path.join(build, command[0])] + \
+                      [part.format(input=path, tokens=stream) for part in command[1:]]
+            return min(measure(command, path if mode in ("stdin", "pipe") else None, mode == "pipe")
+                       for _ in range(args.repeat))
+
+        for name, input_name, mode, command in selected:
+            path, stream, size, tokens = inputs[input_name]
+            seconds, rss = fastest(args.build, command, mode, path, stream)
+            result = {
+                "case": name,
+                "input": input_name,
+                "mode": mode,
+                "bytes": size,
+                "tokens": tokens,
+                "seconds": round(seconds, 6),
+                "mb_per_s": round(size / seconds / 1e6, 2),
+                "tokens_per_s": round(tokens / seconds),
+                "max_rss_kb": rss,
+            }
+            line = "%-30s %9.2f MB/s %12d tokens/s" % (name, size / seconds / 1e6, tokens / seconds)
+            if args.compare:
+                other, other_rss = fastest(args.compare, command, mode, path, stream)
+                result.update({
+                    "compare_seconds": round(other, 6),
+                    "compare_mb_per_s": round(size / other / 1e6, 2),
+                    "compare_max_rss_kb": other_rss,
+                    "speedup": round(other / seconds, 2),
+                })
+                line += "   %9.2f MB/s compared, %.2fx" % (size / other / 1e6, other / seconds)
+            results.append(result)
+            print(line)
+
+    report = {
+        "machine": {"system": platform.system(), "processor": platform.machine(), "cpus": os.cpu_count()},
+        "flex": args.flex,
+        "seed": args.seed,
+        "repeat": args.repeat,
+        "compare": args.compare,
+        "results": results,
+    }
+    if args.flex:
+        report["flex_tables"] = flex_tables(args.build)
+        if args.compare:
+            report["compare_flex_tables"] = flex_tables(args.compare)
+    with open(args.output, "w") as file:
+        json.dump(report, file, indent=2)
+        file.write("\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,12 +1,134 @@
-#include "tokens.hpp"
-#include "output.hpp"
-
-int main() {
-    enum tokentype token;
-
-    // read tokens until the end of file is reached
-    while ((token = static_cast<tokentype>(yylex()))) {
-        // your code here
-    }
-    return 0;
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include "tokens.hpp"
+#include "output.hpp"
+#include "../scanner/input.hpp"
+#include "../scanner/literal.hpp"
+#include "lexer.hpp"
+#include "parallel.hpp"
+#include "tokenstream.hpp"
+#include "../scanner/scanner.hpp"
+#include "../scanner/stats.hpp"
+
+/* Prints the tokens of the flex scanner, up to the first lexical error */
+static void printTokens(scanner::Scanner &scanner) {
+    for (;;) {
+        scanner::Token token = scanner.next();
+        switch (token) {
+            case scanner::Token::END:
+                return;
+            case scanner::Token::STRING:
+                output::printToken(scanner.lineno(), STRING, scanner.value().data(), scanner.value().size());
+                break;
+            case scanner::Token::UNKNOWN_CHAR:
+                output::errorUnknownChar(*scanner.text());
+                break;
+            case scanner::Token::UNCLOSED_STRING:
+                output::errorUnclosedString();
+                break;
+            case scanner::Token::UNDEFINED_ESCAPE:
+                output::errorUndefinedEscape(literal::invalidSequence(scanner.text(), scanner.length()));
+                break;
+            default:
+                output::printToken(scanner.lineno(), static_cast<tokentype>(token), scanner.text());
+                break;
+        }
+    }
+}
+
+/* The count --jobs asks for, at most one job per core. Returns 0 unless text is a positive decimal number */
+static unsigned jobCount(const char *text) {
+    char *end;
+    unsigned long jobs = std::strtoul(text, &end, 10);
+    if (!(*text >= '0' && *text <= '9') || *end != '\0' || jobs == 0) {
+        return 0;
+    }
+    unsigned long cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        cores = UINT_MAX; // The core count is unknown
+    }
+    return static_cast<unsigned>(jobs < cores ? jobs : cores);
+}
+
+int main(int argc, char *argv[]) {
+    enum tokentype token;
+    input::Buffer source;
+    FILE *in = stdin;
+    const char *path = nullptr;
+    bool handWritten = false;
+    unsigned jobs = 1;
+    bool binary = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else if (std::strcmp(argv[i], "--lexer=simd") == 0) {
+            handWritten = true;
+        } else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            // Parallel lexing uses the hand-written lexer, which can start at any line break
+            if (!(jobs = jobCount(argv[++i]))) {
+                std::cerr << "Error: --jobs needs a positive number, not " << argv[i] << std::endl;
+                return 1;
+            }
+            handWritten = true;
+        } else if (std::strcmp(argv[i], "--emit-tokens=binary") == 0) {
+            // The binary stream is produced by the hand-written lexer, in the PARSER dialect hw2 and hw3 scan with
+            binary = true;
+            handWritten = true;
+        } else if (std::strcmp(argv[i], "--lex-stats") == 0) {
+            if (!stats::available) {
+                std::cerr << "Error: --lex-stats needs a build with -DLEX_STATS" << std::endl;
+                return 1;
+            }
+            stats::enable();
+        }
+    }
+
+    // --input <file> scans a regular file straight from an mmap; pipes and other special files are streamed through stdio
+    if (path && !input::map(path, source) && !(in = std::fopen(path, "r"))) {
+        std::cerr << "Error: cannot open " << path << std::endl;
+        return 1;
+    }
+
+    if (handWritten) {
+        // The hand-written lexer works on the whole source at once
+        if (!source.data && !input::load(in, source)) {
+            std::cerr << "Error: cannot read the input" << std::endl;
+            if (in != stdin) {
+                std::fclose(in);
+            }
+            return 1;
+        }
+        if (binary) {
+            tokenstream::Writer writer(output::sink());
+            lexer::Lexer lex(source.data, source.data + source.size, 1, nullptr, scanner::Dialect::PARSER);
+            while ((token = static_cast<tokentype>(lex.next()))) {
+                writer.token(lex.lineno(), token, lex.text(), lex.length());
+            }
+            writer.finish(lex.lineno(), lex.status() == lexer::DONE ? tokenstream::END_OF_INPUT : tokenstream::LEXICAL_ERROR);
+        } else if (jobs > 1) {
+            parallel::lex(source.data, source.data + source.size, jobs);
+        } else {
+            lexer::Lexer lex(source.data, source.data + source.size);
+            lexer::print(lex, output::sink());
+            lex.report();
+        }
+    } else {
+        if (source.data) {
+            scanner::Scanner scanner(source.data, source.size);
+            printTokens(scanner);
+        } else {
+            scanner::Scanner scanner(in);
+            printTokens(scanner);
+        }
+    }
+    output::sink().flush();
+    input::release(source);
+    if (in != stdin) {
+        std::fclose(in);
+    }
+    return 0;
 }
\ No newline at end of file
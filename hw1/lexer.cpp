@@ -0,0 +1,252 @@
+#include "lexer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include "../scanner/literal.hpp"
+#include "output.hpp"
+#include "../scanner/simd.hpp"
+#include "../scanner/stats.hpp"
+
+namespace {
+    struct Keyword {
+        const char *text;
+        tokentype token;
+    };
+
+    const Keyword keywords[] = {
+            {"void",     VOID},
+            {"int",      INT},
+            {"byte",     BYTE},
+            {"bool",     BOOL},
+            {"and",      AND},
+            {"or",       OR},
+            {"not",      NOT},
+            {"true",     TRUE},
+            {"false",    FALSE},
+            {"return",   RETURN},
+            {"if",       IF},
+            {"else",     ELSE},
+            {"while",    WHILE},
+            {"break",    BREAK},
+            {"continue", CONTINUE}
+    };
+
+    // Keywords win over identifiers of the same length, as the keyword rules come first in scanner/scanner.lex
+    tokentype identifier(const char *text, std::size_t length) {
+        for (const Keyword &keyword: keywords) {
+            if (std::strlen(keyword.text) == length && std::memcmp(keyword.text, text, length) == 0) {
+                return keyword.token;
+            }
+        }
+        return ID;
+    }
+}
+
+lexer::Lexer::Lexer(const char *begin, const char *end, int lineno, const char *limit, scanner::Dialect dialect)
+        : current(begin), limit(limit ? limit : end), end(end), line(lineno), dialect(dialect) {}
+
+int lexer::Lexer::fail(Status status, const char *text, std::size_t length) {
+    state = status;
+    tokenText = text;
+    tokenLength = length;
+    return 0;
+}
+
+int lexer::Lexer::string() {
+    const char *start = current;
+    literal::Match match = literal::match(start, end, decoded);
+
+    switch (match.rule) {
+        case literal::PATTERN_OF_STRING:
+            current += match.length;
+            tokenText = start;
+            tokenLength = match.length;
+            return STRING;
+        case literal::INVALID_ESCAPE: {
+            const char *sequence = literal::invalidSequence(start, match.length);
+            return fail(UNDEFINED_ESCAPE, sequence, start + match.length - sequence);
+        }
+        default:
+            return fail(UNCLOSED_STRING, start, match.length);
+    }
+}
+
+// PARSER_STRING: at least one character between the quotes, and only \r \n \t \" and \\ as escapes. When it does
+// not match, the opening quote is an unknown character
+int lexer::Lexer::parserString() {
+    const char *start = current;
+    const char *p = start + 1;
+    for (;;) {
+        p = simd::findStringStop(p, end);
+        if (p == end || *p == '\n' || *p == '\r') {
+            return fail(UNKNOWN_CHAR, start, 1);
+        }
+        if (*p == '"') {
+            break;
+        }
+        if (end - p < 2 || std::memchr("rnt\"\\", p[1], 5) == nullptr) {
+            return fail(UNKNOWN_CHAR, start, 1);
+        }
+        p += 2;
+    }
+    if (p == start + 1) {
+        return fail(UNKNOWN_CHAR, start, 1);
+    }
+    current = p + 1;
+    tokenText = start;
+    tokenLength = current - start;
+    return STRING;
+}
+
+int lexer::Lexer::next() {
+    if (state != RUNNING) {
+        return 0;
+    }
+
+    stats::Timer timer;
+    timer.start();
+    const char *start = simd::skipWhitespace(current, limit);
+    if (start != current) {
+        timer.record(stats::WHITESPACE, start - current);
+    }
+    line += static_cast<int>(std::count(current, start, '\n'));
+    current = start;
+    if (current == limit) {
+        state = DONE;
+        return 0;
+    }
+
+    int token;
+    char c = *current;
+    char lookahead = (end - current > 1) ? current[1] : '\0';
+
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') {
+        current = simd::skipAlnum(current + 1, end);
+        token = identifier(start, current - start);
+    } else if (c >= '0' && c <= '9') {
+        current = (c == '0') ? current + 1 : simd::skipDigits(current + 1, end);
+        token = NUM;
+        // The PARSER dialect only has the lowercase suffix
+        if (current != end && (*current == 'b' || (*current == 'B' && dialect == scanner::Dialect::LEXER))) {
+            ++current;
+            token = NUM_B;
+        }
+    } else {
+        switch (c) {
+            case ';':
+                token = SC;
+                break;
+            case ',':
+                token = COMMA;
+                break;
+            case '(':
+                token = LPAREN;
+                break;
+            case ')':
+                token = RPAREN;
+                break;
+            case '{':
+                token = LBRACE;
+                break;
+            case '}':
+                token = RBRACE;
+                break;
+            case '[':
+                token = LBRACK;
+                break;
+            case ']':
+                token = RBRACK;
+                break;
+            case '=':
+                token = (lookahead == '=') ? RELOP : ASSIGN;
+                current += (lookahead == '=');
+                break;
+            case '!':
+                if (lookahead != '=') {
+                    return fail(UNKNOWN_CHAR, start, 1);
+                }
+                token = RELOP;
+                ++current;
+                break;
+            case '<':
+            case '>':
+                token = RELOP;
+                current += (lookahead == '=');
+                break;
+            case '+':
+            case '-':
+            case '*':
+                token = BINOP;
+                break;
+            case '/':
+                if (lookahead == '/') {
+                    current = simd::findLineEnd(current + 2, end) - 1;
+                    token = COMMENT;
+                } else {
+                    token = BINOP;
+                }
+                break;
+            case '"':
+                token = dialect == scanner::Dialect::PARSER ? parserString() : string();
+                if (token) {
+                    timer.record(STRING, tokenLength);
+                }
+                return token;
+            default:
+                return fail(UNKNOWN_CHAR, start, 1);
+        }
+        ++current;
+    }
+
+    tokenText = start;
+    tokenLength = current - start;
+    timer.record(token, tokenLength);
+    return token;
+}
+
+const char *lexer::Lexer::text() const {
+    return tokenText;
+}
+
+std::size_t lexer::Lexer::length() const {
+    return tokenLength;
+}
+
+const std::string &lexer::Lexer::value() const {
+    return decoded;
+}
+
+int lexer::Lexer::lineno() const {
+    return line;
+}
+
+lexer::Status lexer::Lexer::status() const {
+    return state;
+}
+
+void lexer::Lexer::report() const {
+    switch (state) {
+        case UNKNOWN_CHAR:
+            output::errorUnknownChar(*tokenText);
+            break;
+        case UNCLOSED_STRING:
+            output::errorUnclosedString();
+            break;
+        case UNDEFINED_ESCAPE:
+            output::errorUndefinedEscape(std::string(tokenText, tokenLength).c_str());
+            break;
+        default:
+            break;
+    }
+}
+
+void lexer::print(Lexer &lex, sink::Sink &out) {
+    int token;
+    while ((token = lex.next())) {
+        if (token == STRING) {
+            output::printToken(lex.lineno(), STRING, lex.value().data(), lex.value().size(), out);
+        } else {
+            output::printToken(lex.lineno(), static_cast<tokentype>(token), lex.text(), lex.length(), out);
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef LEXER_HPP
+#define LEXER_HPP
+
+#include <cstddef>
+#include <string>
+#include "tokens.hpp"
+#include "output.hpp"
+#include "../scanner/scanner.hpp"
+
+namespace lexer {
+
+    /* How scanning stopped */
+    enum Status {
+        RUNNING,
+        DONE,
+        UNKNOWN_CHAR,
+        UNCLOSED_STRING,
+        UNDEFINED_ESCAPE
+    };
+
+    /* Hand-written alternative to the flex scanner in scanner/scanner.lex. It works on a buffer that holds the whole
+     * source and returns the same tokens in the same dialect, with the same text and line numbers, and stops on the
+     * same lexical errors. In the PARSER dialect a lexical error is an UNKNOWN_CHAR, where the flex scanner returns
+     * the character and goes on. Whitespace, comments, identifiers, numbers and string bodies are skipped with the
+     * vector scans of simd.hpp instead of a DFA step per byte */
+    class Lexer {
+    private:
+        const char *current;
+        const char *limit;
+        const char *end;
+        const char *tokenText = nullptr;
+        std::size_t tokenLength = 0;
+        std::string decoded;
+        int line;
+        scanner::Dialect dialect;
+        Status state = RUNNING;
+
+        int string();
+
+        int parserString();
+
+        int fail(Status status, const char *text, std::size_t length);
+
+    public:
+        /* lexes [begin, end). When limit is given, tokens only start before it but may still look ahead up to end,
+         * which lets a chunk of a larger buffer be lexed exactly as the serial scan would lex it */
+        Lexer(const char *begin, const char *end, int lineno = 1, const char *limit = nullptr,
+              scanner::Dialect dialect = scanner::Dialect::LEXER);
+
+        /* returns the next token, or 0 once the input is exhausted or a lexical error was found (see status) */
+        int next();
+
+        /* text and length of the last token, or of the offending input after an error. For UNDEFINED_ESCAPE
+         * this is the sequence the flex scanner reports, which may run into the next line */
+        const char *text() const;
+
+        std::size_t length() const;
+
+        /* decoded value of the last STRING token, as printToken prints it */
+        const std::string &value() const;
+
+        int lineno() const;
+
+        Status status() const;
+
+        /* reports the lexical error that stopped the lexer through the output error functions, which exit */
+        void report() const;
+    };
+
+    /* prints every remaining token of lex to out the way scanner/scanner.lex prints them, until the end of input or
+     * the first lexical error */
+    void print(Lexer &lex, sink::Sink &out);
+}
+
+#endif //LEXER_HPP
@@ -1,60 +1,79 @@
-#include "output.hpp"
-#include <iostream>
-
-static const std::string token_names[] = {
-        "__FILLER_FOR_ZERO",
-        "VOID",
-        "INT",
-        "BYTE",
-        "BOOL",
-        "AND",
-        "OR",
-        "NOT",
-        "TRUE",
-        "FALSE",
-        "RETURN",
-        "IF",
-        "ELSE",
-        "WHILE",
-        "BREAK",
-        "CONTINUE",
-        "SC",
-        "COMMA",
-        "LPAREN",
-        "RPAREN",
-        "LBRACE",
-        "RBRACE",
-        "LBRACK",
-        "RBRACK",
-        "ASSIGN",
-        "RELOP",
-        "BINOP",
-        "COMMENT",
-        "ID",
-        "NUM",
-        "NUM_B",
-        "STRING"
-};
-
-void output::printToken(int lineno, enum tokentype token, const char *value) {
-    if (token == COMMENT) {
-        std::cout << lineno << " COMMENT //" << std::endl;
-    } else {
-        std::cout << lineno << " " << token_names[token] << " " << value << std::endl;
-    }
-}
-
-void output::errorUnknownChar(char c) {
-    std::cout << "ERROR: Unknown character " << c << std::endl;
-    exit(0);
-}
-
-void output::errorUnclosedString() {
-    std::cout << "ERROR: Unclosed string" << std::endl;
-    exit(0);
-}
-
-void output::errorUndefinedEscape(const char *sequence) {
-    std::cout << "ERROR: Undefined escape sequence " << sequence << std::endl;
-    exit(0);
-}
+#include "output.hpp"
+#include <cstring>
+#include <iostream>
+
+static const std::string token_names[] = {
+        "__FILLER_FOR_ZERO",
+        "VOID",
+        "INT",
+        "BYTE",
+        "BOOL",
+        "AND",
+        "OR",
+        "NOT",
+        "TRUE",
+        "FALSE",
+        "RETURN",
+        "IF",
+        "ELSE",
+        "WHILE",
+        "BREAK",
+        "CONTINUE",
+        "SC",
+        "COMMA",
+        "LPAREN",
+        "RPAREN",
+        "LBRACE",
+        "RBRACE",
+        "LBRACK",
+        "RBRACK",
+        "ASSIGN",
+        "RELOP",
+        "BINOP",
+        "COMMENT",
+        "ID",
+        "NUM",
+        "NUM_B",
+        "STRING"
+};
+
+sink::Sink &output::sink() {
+    static sink::Sink tokens(stdout);
+    return tokens;
+}
+
+void output::printToken(int lineno, enum tokentype token, const char *value) {
+    printToken(lineno, token, value, std::strlen(value));
+}
+
+void output::printToken(int lineno, enum tokentype token, const char *value, std::size_t length, sink::Sink &out) {
+    out.putNumber(lineno);
+    if (token == COMMENT) {
+        out.write(" COMMENT //\n", 12);
+    } else {
+        const std::string &name = token_names[token];
+        out.put(' ');
+        out.write(name.data(), name.size());
+        out.put(' ');
+        out.write(value, length);
+        out.put('\n');
+    }
+}
+
+void output::errorUnknownChar(char c) {
+    sink().flush();
+    std::cout << "ERROR: Unknown character " << c << std::endl;
+    exit(0);
+}
+
+void output::errorUnclosedString() {
+    sink().flush();
+    std::cout << "ERROR: Unclosed string" << std::endl;
+    exit(0);
+}
+
+void output::errorUndefinedEscape(const char *sequence) {
+    sink().flush();
+    std::cout << "ERROR: Undefined escape sequence " << sequence << std::endl;
+    exit(0);
+}
@@ -1,20 +1,28 @@
-#ifndef OUTPUT_HPP
-#define OUTPUT_HPP
-
-#include "tokens.hpp"
-
-namespace output {
-
-    /* prints the token with the given line number, type, and value. For COMMENT value is ignored */
-    void printToken(int lineno, enum tokentype token, const char *value);
-
-    /* Error handling functions */
-
-    void errorUnknownChar(char c);
-
-    void errorUnclosedString();
-
-    void errorUndefinedEscape(const char* sequence);
-}
-
-#endif //OUTPUT_HPP
+#ifndef OUTPUT_HPP
+#define OUTPUT_HPP
+
+#include <cstddef>
+#include "tokens.hpp"
+#include "../scanner/sink.hpp"
+
+namespace output {
+
+    /* the sink behind printToken. Flushed at the end of input and before every error */
+    sink::Sink &sink();
+
+    /* prints the token with the given line number, type, and value. For COMMENT value is ignored */
+    void printToken(int lineno, enum tokentype token, const char *value);
+
+    /* same as above for a value that is not NUL terminated, written to the given sink */
+    void printToken(int lineno, enum tokentype token, const char *value, std::size_t length, sink::Sink &out = sink());
+
+    /* Error handling functions */
+
+    void errorUnknownChar(char c);
+
+    void errorUnclosedString();
+
+    void errorUndefinedEscape(const char* sequence);
+}
+
+#endif //OUTPUT_HPP
@@ -0,0 +1,101 @@
+#include "parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "lexer.hpp"
+#include "output.hpp"
+
+namespace {
+    struct Chunk {
+        const char *begin;
+        // Tokens start before limit, which is just past a newline or the end of the buffer
+        const char *limit;
+        int lineno = 1;
+        sink::Sink out;
+        std::unique_ptr<lexer::Lexer> lex;
+        bool done = false;
+
+        Chunk(const char *begin, const char *limit) : begin(begin), limit(limit) {}
+    };
+
+    // Runs work(i) for every i in [0, count) on the given number of threads, until stop is set
+    template<class Work>
+    void forEach(std::size_t count, unsigned jobs, const std::atomic<bool> &stop, Work work) {
+        std::atomic<std::size_t> next(0);
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < jobs; ++t) {
+            threads.emplace_back([&] {
+                for (std::size_t i; !stop && (i = next++) < count;) {
+                    work(i);
+                }
+            });
+        }
+        for (std::thread &thread: threads) {
+            thread.join();
+        }
+    }
+}
+
+void parallel::lex(const char *begin, const char *end, unsigned jobs) {
+    std::atomic<bool> stop(false);
+    jobs = std::max(jobs, 1u);
+
+    // A few chunks per thread keeps every thread busy when some chunks lex slower than others
+    std::size_t target = std::max<std::size_t>((end - begin) / (jobs * 4) + 1, 1 << 20);
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    for (const char *p = begin; p < end;) {
+        const char *cut = p + std::min<std::size_t>(target, end - p);
+        if (cut < end) {
+            const char *newline = static_cast<const char *>(std::memchr(cut, '\n', end - cut));
+            cut = newline ? newline + 1 : end;
+        }
+        chunks.push_back(std::make_unique<Chunk>(p, cut));
+        p = cut;
+    }
+
+    std::vector<int> newlines(chunks.size());
+    forEach(chunks.size(), jobs, stop, [&](std::size_t i) {
+        newlines[i] = static_cast<int>(std::count(chunks[i]->begin, chunks[i]->limit, '\n'));
+    });
+    for (std::size_t i = 1; i < chunks.size(); ++i) {
+        chunks[i]->lineno = chunks[i - 1]->lineno + newlines[i - 1];
+    }
+
+    // The workers lex chunks while this thread writes the finished ones out in order
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::thread workers([&] {
+        forEach(chunks.size(), jobs, stop, [&](std::size_t i) {
+            Chunk &chunk = *chunks[i];
+            chunk.lex = std::make_unique<lexer::Lexer>(chunk.begin, end, chunk.lineno, chunk.limit);
+            lexer::print(*chunk.lex, chunk.out);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunk.done = true;
+            }
+            finished.notify_all();
+        });
+    });
+
+    for (std::unique_ptr<Chunk> &chunk: chunks) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&] { return chunk->done; });
+        }
+        const std::string &text = chunk->out.contents();
+        output::sink().write(text.data(), text.size());
+        if (chunk->lex->status() != lexer::DONE) {
+            // Later chunks may hold errors too, but this one comes first in the source
+            stop = true;
+            workers.join();
+            chunk->lex->report();
+        }
+        chunk.reset();
+    }
+    workers.join();
+}
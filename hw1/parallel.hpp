@@ -0,0 +1,14 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+namespace parallel {
+
+    /* Lexes [begin, end) with the hand-written lexer on the given number of threads and prints exactly what one
+     * serial run prints. No token crosses a newline, so the buffer is cut into chunks right after newlines. Each
+     * chunk learns its first line number from a parallel newline count and prints into its own memory sink, and
+     * the chunks are written out in source order as they finish. The first chunk that stopped on a lexical error
+     * reports it after its tokens, which is the error the serial scan reports */
+    void lex(const char *begin, const char *end, unsigned jobs);
+}
+
+#endif //PARALLEL_HPP
@@ -0,0 +1,49 @@
+#include "tokenstream.hpp"
+
+tokenstream::Writer::Writer(sink::Sink &out) : out(out) {
+    out.write(magic, sizeof(magic));
+    out.put(static_cast<char>(version));
+}
+
+void tokenstream::Writer::putVarint(std::uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+void tokenstream::Writer::putLine(int lineno) {
+    putVarint(static_cast<std::uint64_t>(lineno - line));
+    line = lineno;
+}
+
+void tokenstream::Writer::token(int lineno, tokentype token, const char *text, std::size_t length) {
+    out.put(static_cast<char>(token));
+    putLine(lineno);
+
+    switch (token) {
+        case ID:
+        case NUM:
+        case NUM_B:
+        case STRING:
+        case RELOP:
+        case BINOP:
+            break;
+        default:
+            return;
+    }
+
+    auto inserted = lexemes.emplace(std::string_view(text, length), static_cast<std::uint32_t>(lexemes.size()));
+    putVarint(inserted.first->second);
+    if (inserted.second) {
+        putVarint(length);
+        out.write(text, length);
+    }
+}
+
+void tokenstream::Writer::finish(int lineno, Status status) {
+    out.put('\0');
+    putLine(lineno);
+    out.put(static_cast<char>(status));
+}
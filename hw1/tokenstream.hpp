@@ -0,0 +1,55 @@
+#ifndef TOKENSTREAM_HPP
+#define TOKENSTREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include "tokens.hpp"
+#include "output.hpp"
+
+namespace tokenstream {
+
+    /* Binary token stream written by --emit-tokens=binary and read back by the hw2 and hw3 front ends
+     * (their tokenstream.cpp). Layout:
+     *
+     *   header   "FCTK" followed by the version byte
+     *   token    uint8 kind (tokentype), varint line delta from the previous record, and for ID, NUM, NUM_B,
+     *            STRING, RELOP and BINOP a varint index into the lexeme table. An index equal to the current
+     *            size of the table adds a new entry, spelled out right after it as a varint length and the bytes
+     *   end      uint8 0, varint line delta, uint8 status: 0 at the end of input, 1 after a lexical error. After an
+     *            error, the end record is on the line of the first character no PARSER rule matches
+     *
+     * The tokens follow the PARSER dialect of scanner/scanner.lex, the one hw2 and hw3 scan with, so a stream parses
+     * as the source would. Version 1 streams held the LEXER dialect of hw1 and are refused. Lexemes are the raw
+     * source text (strings keep their quotes and escapes). Varints are little-endian base 128 */
+    const char magic[4] = {'F', 'C', 'T', 'K'};
+    const std::uint8_t version = 2;
+
+    enum Status : std::uint8_t {
+        END_OF_INPUT = 0,
+        LEXICAL_ERROR = 1
+    };
+
+    class Writer {
+    private:
+        sink::Sink &out;
+        int line = 1;
+        // Keys point into the source buffer, which outlives the writer
+        std::unordered_map<std::string_view, std::uint32_t> lexemes;
+
+        void putVarint(std::uint64_t value);
+
+        void putLine(int lineno);
+
+    public:
+        /* writes the header */
+        explicit Writer(sink::Sink &out);
+
+        void token(int lineno, tokentype token, const char *text, std::size_t length);
+
+        void finish(int lineno, Status status);
+    };
+}
+
+#endif //TOKENSTREAM_HPP
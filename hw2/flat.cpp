@@ -0,0 +1,442 @@
+#include "flat.hpp"
+#include <utility>
+
+namespace flat {
+
+    using ast::Kind;
+
+    namespace {
+
+        /* Adds the children of a node before the node itself. Like the visitors, it keeps its own stack of tasks
+         * instead of recursing, so no nesting depth overflows the native stack. A node is visited twice: the
+         * first visit schedules its children and the node again after them, the second adds the node with the
+         * indices its children were given, which are in lowered. Each second visit leaves the index in added */
+        class Lowering final : public Visitor {
+        private:
+            struct Task {
+                ast::Node *node;
+                // Children whose indices the second visit takes, or -1 on the first visit
+                std::int64_t children;
+            };
+
+            Builder builder;
+            std::vector<Task> tasks;
+            // Indices of the lowered nodes whose parents are not added yet, the last one on top
+            std::vector<Index> results;
+            std::vector<Index> lowered;
+            Task current{};
+            bool scheduled = false;
+            Index added = NONE;
+
+            // First visit: schedules the node after children, the first child next, and returns true.
+            // Second visit: moves the indices of the children to lowered and returns false
+            bool expand(std::initializer_list<ast::Node *> children) {
+                if (current.children < 0) {
+                    tasks.push_back({current.node, static_cast<std::int64_t>(children.size())});
+                    for (auto child = children.end(); child != children.begin();) {
+                        tasks.push_back({*--child, -1});
+                    }
+                    scheduled = true;
+                    return true;
+                }
+                take();
+                return false;
+            }
+
+            template<typename T>
+            bool expandAll(const std::vector<std::shared_ptr<T>> &children) {
+                if (current.children < 0) {
+                    tasks.push_back({current.node, static_cast<std::int64_t>(children.size())});
+                    for (auto child = children.rbegin(); child != children.rend(); ++child) {
+                        tasks.push_back({child->get(), -1});
+                    }
+                    scheduled = true;
+                    return true;
+                }
+                take();
+                return false;
+            }
+
+            void take() {
+                auto first = results.end() - current.children;
+                lowered.assign(first, results.end());
+                results.erase(first, results.end());
+            }
+
+            template<typename... Args>
+            Index add(Kind kind, Args &&... args) {
+                return builder.add(static_cast<Tag>(kind), std::forward<Args>(args)...);
+            }
+
+        public:
+            explicit Lowering(Tree &tree) : builder(tree) {}
+
+            Index lower(ast::Node &program) {
+                tasks.push_back({&program, -1});
+                while (!tasks.empty()) {
+                    current = tasks.back();
+                    tasks.pop_back();
+                    if (!current.node) {
+                        results.push_back(NONE);
+                        continue;
+                    }
+                    scheduled = false;
+                    current.node->accept(*this);
+                    if (!scheduled) {
+                        results.push_back(added);
+                    }
+                }
+                return results.back();
+            }
+
+            void visit(ast::Num &node) override {
+                added = add(Kind::NUM, node.line, node.value);
+            }
+
+            void visit(ast::NumB &node) override {
+                added = add(Kind::NUM_B, node.line, node.value);
+            }
+
+            void visit(ast::String &node) override {
+                added = add(Kind::STRING, node.line, node.value);
+            }
+
+            void visit(ast::Bool &node) override {
+                added = add(Kind::BOOL, node.line, node.value);
+            }
+
+            void visit(ast::ID &node) override {
+                added = add(Kind::ID, node.line, node.value);
+            }
+
+            void visit(ast::BinOp &node) override {
+                if (expand({node.left.get(), node.right.get()})) {
+                    return;
+                }
+                added = add(Kind::BIN_OP, node.line, node.op, lowered);
+            }
+
+            void visit(ast::RelOp &node) override {
+                if (expand({node.left.get(), node.right.get()})) {
+                    return;
+                }
+                added = add(Kind::REL_OP, node.line, node.op, lowered);
+            }
+
+            void visit(ast::Not &node) override {
+                if (expand({node.exp.get()})) {
+                    return;
+                }
+                added = add(Kind::NOT, node.line, 0, lowered);
+            }
+
+            void visit(ast::And &node) override {
+                if (expand({node.left.get(), node.right.get()})) {
+                    return;
+                }
+                added = add(Kind::AND, node.line, 0, lowered);
+            }
+
+            void visit(ast::Or &node) override {
+                if (expand({node.left.get(), node.right.get()})) {
+                    return;
+                }
+                added = add(Kind::OR, node.line, 0, lowered);
+            }
+
+            void visit(ast::Type &node) override {
+                added = add(Kind::TYPE, node.line, node.type);
+            }
+
+            void visit(ast::Cast &node) override {
+                if (expand({node.exp.get(), node.target_type.get()})) {
+                    return;
+                }
+                added = add(Kind::CAST, node.line, 0, lowered);
+            }
+
+            void visit(ast::ExpList &node) override {
+                if (expandAll(node.exps)) {
+                    return;
+                }
+                added = add(Kind::EXP_LIST, node.line, 0, lowered);
+            }
+
+            void visit(ast::Call &node) override {
+                if (expand({node.func_id.get(), node.args.get()})) {
+                    return;
+                }
+                added = add(Kind::CALL, node.line, 0, lowered);
+            }
+
+            void visit(ast::Statements &node) override {
+                if (expandAll(node.statements)) {
+                    return;
+                }
+                added = add(Kind::STATEMENTS, node.line, 0, lowered);
+            }
+
+            void visit(ast::Break &node) override {
+                added = add(Kind::BREAK, node.line, 0);
+            }
+
+            void visit(ast::Continue &node) override {
+                added = add(Kind::CONTINUE, node.line, 0);
+            }
+
+            void visit(ast::Return &node) override {
+                if (expand({node.exp.get()})) {
+                    return;
+                }
+                added = add(Kind::RETURN, node.line, 0, lowered);
+            }
+
+            void visit(ast::If &node) override {
+                if (expand({node.condition.get(), node.then.get(), node.otherwise.get()})) {
+                    return;
+                }
+                added = add(Kind::IF, node.line, 0, lowered);
+            }
+
+            void visit(ast::While &node) override {
+                if (expand({node.condition.get(), node.body.get()})) {
+                    return;
+                }
+                added = add(Kind::WHILE, node.line, 0, lowered);
+            }
+
+            void visit(ast::VarDecl &node) override {
+                if (expand({node.id.get(), node.type.get(), node.init_exp.get()})) {
+                    return;
+                }
+                added = add(Kind::VAR_DECL, node.line, 0, lowered);
+            }
+
+            void visit(ast::Assign &node) override {
+                if (expand({node.id.get(), node.exp.get()})) {
+                    return;
+                }
+                added = add(Kind::ASSIGN, node.line, 0, lowered);
+            }
+
+            void visit(ast::Formal &node) override {
+                if (expand({node.id.get(), node.type.get()})) {
+                    return;
+                }
+                added = add(Kind::FORMAL, node.line, 0, lowered);
+            }
+
+            void visit(ast::Formals &node) override {
+                if (expandAll(node.formals)) {
+                    return;
+                }
+                added = add(Kind::FORMALS, node.line, 0, lowered);
+            }
+
+            void visit(ast::FuncDecl &node) override {
+                if (expand({node.id.get(), node.return_type.get(), node.formals.get(), node.body.get()})) {
+                    return;
+                }
+                added = add(Kind::FUNC_DECL, node.line, 0, lowered);
+            }
+
+            void visit(ast::Funcs &node) override {
+                if (expandAll(node.funcs)) {
+                    return;
+                }
+                added = add(Kind::FUNCS, node.line, 0, lowered);
+            }
+        };
+
+        /* Builds the nodes in index order, so the children of a node already exist when it is built */
+        class Inflater {
+        private:
+            const View &tree;
+            ast::Arena &arena;
+            std::vector<std::shared_ptr<ast::Node>> nodes;
+            Index current = 0;
+
+            template<typename T, typename... Args>
+            std::shared_ptr<T> make(Args &&... args) {
+                std::shared_ptr<T> node = arena.make<T>(std::forward<Args>(args)...);
+                node->line = tree.lines[current];
+                nodes[current] = node;
+                return node;
+            }
+
+            // The child at position of the current node, as a node of class T
+            template<typename T>
+            std::shared_ptr<T> child(std::uint32_t position) const {
+                Index index = tree.child(current, position);
+                return index == NONE ? nullptr : std::static_pointer_cast<T>(nodes[index]);
+            }
+
+            std::shared_ptr<ast::Exp> exp(std::uint32_t position) const {
+                return child<ast::Exp>(position);
+            }
+
+            std::shared_ptr<ast::Statement> statement(std::uint32_t position) const {
+                return child<ast::Statement>(position);
+            }
+
+            void build() {
+                std::int32_t payload = tree.payloads[current];
+                switch (static_cast<Kind>(tree.kinds[current])) {
+                    case Kind::NUM:
+                        make<ast::Num>(payload);
+                        break;
+                    case Kind::NUM_B:
+                        make<ast::NumB>(payload);
+                        break;
+                    case Kind::STRING:
+                        make<ast::String>("\"\"", 2)->value = tree.text(current);
+                        break;
+                    case Kind::BOOL:
+                        make<ast::Bool>(payload != 0);
+                        break;
+                    case Kind::ID:
+                        make<ast::ID>(tree.text(current));
+                        break;
+                    case Kind::BIN_OP:
+                        make<ast::BinOp>(exp(0), exp(1), static_cast<ast::BinOpType>(payload));
+                        break;
+                    case Kind::REL_OP:
+                        make<ast::RelOp>(exp(0), exp(1), static_cast<ast::RelOpType>(payload));
+                        break;
+                    case Kind::NOT:
+                        make<ast::Not>(exp(0));
+                        break;
+                    case Kind::AND:
+                        make<ast::And>(exp(0), exp(1));
+                        break;
+                    case Kind::OR:
+                        make<ast::Or>(exp(0), exp(1));
+                        break;
+                    case Kind::TYPE:
+                        make<ast::Type>(static_cast<ast::BuiltInType>(payload));
+                        break;
+                    case Kind::CAST:
+                        make<ast::Cast>(exp(0), child<ast::Type>(1));
+                        break;
+                    case Kind::EXP_LIST: {
+                        auto list = make<ast::ExpList>();
+                        for (std::uint32_t i = 0; i < tree.counts[current]; ++i) {
+                            list->push_back(exp(i));
+                        }
+                        break;
+                    }
+                    case Kind::CALL:
+                        make<ast::Call>(child<ast::ID>(0), child<ast::ExpList>(1));
+                        break;
+                    case Kind::STATEMENTS: {
+                        auto block = make<ast::Statements>();
+                        for (std::uint32_t i = 0; i < tree.counts[current]; ++i) {
+                            block->push_back(statement(i));
+                        }
+                        break;
+                    }
+                    case Kind::BREAK:
+                        make<ast::Break>();
+                        break;
+                    case Kind::CONTINUE:
+                        make<ast::Continue>();
+                        break;
+                    case Kind::RETURN:
+                        make<ast::Return>(exp(0));
+                        break;
+                    case Kind::IF:
+                        make<ast::If>(exp(0), statement(1), statement(2));
+                        break;
+                    case Kind::WHILE:
+                        make<ast::While>(exp(0), statement(1));
+                        break;
+                    case Kind::VAR_DECL:
+                        make<ast::VarDecl>(child<ast::ID>(0), child<ast::Type>(1), exp(2));
+                        break;
+                    case Kind::ASSIGN:
+                        make<ast::Assign>(child<ast::ID>(0), exp(1));
+                        break;
+                    case Kind::FORMAL:
+                        make<ast::Formal>(child<ast::ID>(0), child<ast::Type>(1));
+                        break;
+                    case Kind::FORMALS: {
+                        auto formals = make<ast::Formals>();
+                        for (std::uint32_t i = 0; i < tree.counts[current]; ++i) {
+                            formals->push_back(child<ast::Formal>(i));
+                        }
+                        break;
+                    }
+                    case Kind::FUNC_DECL:
+                        make<ast::FuncDecl>(child<ast::ID>(0), child<ast::Type>(1), child<ast::Formals>(2),
+                                            child<ast::Statements>(3));
+                        break;
+                    case Kind::FUNCS: {
+                        auto funcs = make<ast::Funcs>();
+                        for (std::uint32_t i = 0; i < tree.counts[current]; ++i) {
+                            funcs->push_back(child<ast::FuncDecl>(i));
+                        }
+                        break;
+                    }
+                }
+            }
+
+        public:
+            Inflater(const View &tree, ast::Arena &arena)
+                    : tree(tree), arena(arena), nodes(tree.size) {}
+
+            std::shared_ptr<ast::Node> inflate() {
+                for (current = 0; current < tree.size; ++current) {
+                    build();
+                }
+                return tree.size ? nodes[tree.root()] : nullptr;
+            }
+        };
+    }
+
+    Index lower(ast::Node &program, Tree &tree) {
+        return Lowering(tree).lower(program);
+    }
+
+    std::shared_ptr<ast::Node> inflate(const View &tree, ast::Arena &arena) {
+        return Inflater(tree, arena).inflate();
+    }
+
+    namespace {
+
+        /* A rule for each kind, in the order of ast::Kind. The letters of the kinds a child slot may name are i an
+         * ID, t a TYPE, x an EXP_LIST, f a FORMAL, F a FORMALS, b a STATEMENTS and d a FUNC_DECL */
+        const Rule rules[] = {
+                {"", 0, Role::EXP},                                             // NUM
+                {"", 0, Role::EXP},                                             // NUM_B
+                {"", 0, Role::EXP, Payload::TEXT},                              // STRING
+                {"", 0, Role::EXP},                                             // BOOL
+                {"", 'i', Role::EXP, Payload::TEXT},                            // ID
+                {"ee", 0, Role::EXP, Payload::RANGE, ast::ADD, ast::DIV},       // BIN_OP
+                {"ee", 0, Role::EXP, Payload::RANGE, ast::EQ, ast::GE},         // REL_OP
+                {"e", 0, Role::EXP},                                            // NOT
+                {"ee", 0, Role::EXP},                                           // AND
+                {"ee", 0, Role::EXP},                                           // OR
+                {"", 't', Role::OTHER, Payload::RANGE, ast::VOID, ast::STRING}, // TYPE
+                {"et", 0, Role::EXP},                                           // CAST
+                {"e*", 'x', Role::OTHER},                                       // EXP_LIST
+                {"ix", 0, Role::EXP},                                           // CALL
+                {"s*", 'b', Role::STATEMENT},                                   // STATEMENTS
+                {"", 0, Role::STATEMENT},                                       // BREAK
+                {"", 0, Role::STATEMENT},                                       // CONTINUE
+                {"E", 0, Role::STATEMENT},                                      // RETURN
+                {"esS", 0, Role::STATEMENT},                                    // IF
+                {"es", 0, Role::STATEMENT},                                     // WHILE
+                {"itE", 0, Role::STATEMENT},                                    // VAR_DECL
+                {"ie", 0, Role::STATEMENT},                                     // ASSIGN
+                {"it", 'f', Role::OTHER},                                       // FORMAL
+                {"f*", 'F', Role::OTHER},                                       // FORMALS
+                {"itFb", 'd', Role::OTHER},                                     // FUNC_DECL
+                {"d*", 0, Role::OTHER}                                          // FUNCS
+        };
+
+        static_assert(sizeof(rules) / sizeof(rules[0]) == static_cast<std::size_t>(Kind::FUNCS) + 1,
+                      "a rule for each kind");
+    }
+
+    const Grammar GRAMMAR{2, rules, sizeof(rules) / sizeof(rules[0]), static_cast<Tag>(Kind::FUNCS)};
+}
@@ -1,16 +1,98 @@
+#include <cstring>
+#include <iostream>
+#include <memory>
 #include "output.hpp"
 #include "nodes.hpp"
+#include "tokenstream.hpp"
+#include "../scanner/arena.hpp"
+#include "flat.hpp"
+#include "../scanner/input.hpp"
+#include "../scanner/stats.hpp"
 
-// Extern from the bison-generated parser
-extern int yyparse();
+// The bison-generated parser
+#include "parser.tab.h"
 
-extern std::shared_ptr<ast::Node> program;
+int main(int argc, char *argv[]) {
+    tokenstream::Reader tokens;
+    bool stream = false;
+    output::Format format = output::Format::TREE;
+    const char *emitPath = nullptr;
+    const char *loadPath = nullptr;
 
-int main() {
-    // Parse the input. The result is stored in the global variable `program`
-    yyparse();
+    // --tokens <file> parses a token stream written by hw1 --emit-tokens=binary instead of scanning stdin
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--tokens") == 0 && i + 1 < argc) {
+            if (!tokens.open(argv[++i])) {
+                std::cerr << "Error: cannot read token stream " << argv[i] << std::endl;
+                return 1;
+            }
+            stream = true;
+        } else if (std::strcmp(argv[i], "--lex-stats") == 0) {
+            if (!stats::available) {
+                std::cerr << "Error: --lex-stats needs a build with -DLEX_STATS" << std::endl;
+                return 1;
+            }
+            stats::enable();
+        } else if (std::strncmp(argv[i], "--format=", 9) == 0) {
+            // --format=tree|json|sexp picks how the AST is printed
+            const char *name = argv[i] + 9;
+            if (std::strcmp(name, "tree") == 0) {
+                format = output::Format::TREE;
+            } else if (std::strcmp(name, "json") == 0) {
+                format = output::Format::JSON;
+            } else if (std::strcmp(name, "sexp") == 0) {
+                format = output::Format::SEXP;
+            } else {
+                std::cerr << "Error: unknown format " << name << std::endl;
+                return 1;
+            }
+        } else if (std::strncmp(argv[i], "--emit-ast=", 11) == 0) {
+            // Also writes the parsed program to a binary AST file
+            emitPath = argv[i] + 11;
+        } else if (std::strncmp(argv[i], "--load-ast=", 11) == 0) {
+            // Prints a program loaded from a binary AST file instead of parsing stdin
+            loadPath = argv[i] + 11;
+        }
+    }
+
+    ast::Arena arena; // Owns every node of the AST
+    input::Buffer buffer; // The source read from stdin, which string nodes point into, kept until the end
+    std::shared_ptr<ast::Node> program;
+    flat::Mapping mapping;
+    if (loadPath) {
+        if (!mapping.open(loadPath, flat::GRAMMAR)) {
+            std::cerr << "Error: cannot load AST " << loadPath << std::endl;
+            return 1;
+        }
+        program = flat::inflate(mapping.view(), arena);
+    } else {
+        // Parse the input. The result is stored in `program`
+        std::unique_ptr<scanner::Scanner> scanner;
+        if (!stream) {
+            if (!input::load(stdin, buffer)) {
+                std::cerr << "Error: cannot read the input" << std::endl;
+                return 1;
+            }
+            scanner = std::make_unique<scanner::Scanner>(buffer.data, buffer.size, scanner::Dialect::PARSER);
+        }
+        tokenstream::Source source = stream ? tokenstream::Source(tokens) : tokenstream::Source(*scanner);
+        yy::parser parser(source, arena, program);
+        parser.parse();
+    }
+
+    if (emitPath) {
+        flat::Tree tree;
+        flat::lower(*program, tree);
+        if (!flat::save(tree, flat::GRAMMAR, emitPath)) {
+            std::cerr << "Error: cannot write AST " << emitPath << std::endl;
+            return 1;
+        }
+    }
 
     // Print the AST using the PrintVisitor
-    output::PrintVisitor printVisitor;
-    program->accept(printVisitor);
+    {
+        output::PrintVisitor printVisitor(format);
+        program->accept(printVisitor);
+    }
+    input::release(buffer);
 }
@@ -1,10 +1,14 @@
 #ifndef NODES_HPP
 #define NODES_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "visitor.hpp"
+#include "../scanner/symbols.hpp"
 
 namespace ast {
 
@@ -35,27 +39,64 @@ namespace ast {
         STRING
     };
 
+    /* Kinds of nodes, one for each class below */
+    enum class Kind : std::uint8_t {
+        NUM,
+        NUM_B,
+        STRING,
+        BOOL,
+        ID,
+        BIN_OP,
+        REL_OP,
+        NOT,
+        AND,
+        OR,
+        TYPE,
+        CAST,
+        EXP_LIST,
+        CALL,
+        STATEMENTS,
+        BREAK,
+        CONTINUE,
+        RETURN,
+        IF,
+        WHILE,
+        VAR_DECL,
+        ASSIGN,
+        FORMAL,
+        FORMALS,
+        FUNC_DECL,
+        FUNCS
+    };
+
     /* Base class for all AST nodes */
     class Node {
     public:
+        // Kind of the node, which names its class
+        const Kind kind;
+
         // Line number in the source code
         int line;
 
         // Use this constructor only while parsing in bison or flex
-        Node();
+        explicit Node(Kind kind);
 
-        // Accept method for visitor pattern
-        virtual void accept(Visitor &visitor) = 0;
+        // Accept method for visitor pattern. A switch on the kind passes the node to the visit() of its class, so
+        // the call is direct, with no virtual call at all, when V is a final class
+        template<typename V>
+        void accept(V &visitor);
     };
 
-    /* Base class for all expressions */
-    class Exp : virtual public Node {
+    /* Base class for all statements */
+    class Statement : public Node {
     public:
-        Exp() = default;
+        explicit Statement(Kind kind);
     };
 
-    /* Base class for all statements */
-    class Statement : virtual public Node {
+    /* Base class for all expressions. An expression is also a statement, so a call can stand as one */
+    class Exp : public Statement {
+    public:
+        explicit Exp(Kind kind);
     };
 
     /* Number literal */
@@ -64,12 +105,8 @@ namespace ast {
         // Value of the number
         int value;
 
-        // Constructor that receives a C-style string that represents the number
-        explicit Num(const char *str);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
+        // Constructor that receives the value, parsed by the token source
+        explicit Num(int value);
     };
 
     /* Byte literal */
@@ -78,26 +115,18 @@ namespace ast {
         // Value of the number
         int value;
 
-        // Constructor that receives a C-style (including b character) string that represents the number
-        explicit NumB(const char *str);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
+        // Constructor that receives the value, parsed by the token source without the b character
+        explicit NumB(int value);
     };
 
     /* String literal */
     class String : public Exp {
     public:
-        // Value of the string
-        std::string value;
-
-        // Constructor that receives a C-style string that represents the string *including quotes*
-        explicit String(const char *str);
+        // Value of the string, a view into the source, which outlives the AST
+        std::string_view value;
 
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
+        // Constructor that receives the length characters at str that represent the string *including quotes*
+        String(const char *str, std::size_t length);
     };
 
     /* Boolean literal */
@@ -108,24 +137,26 @@ namespace ast {
 
         // Constructor that receives the boolean value
         explicit Bool(bool value);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Identifier */
     class ID : public Exp {
     public:
-        // Name of the identifier
-        std::string value;
+        // Symbol of the name, the same for every occurrence of the name, so names are compared as symbols
+        symbols::Symbol symbol;
+        // Hash of the name, computed once when the name was interned
+        std::uint32_t hash;
+        // Name of the identifier, owned by the identifier table
+        const std::string &value;
 
         // Constructor that receives a C-style string that represents the identifier
         explicit ID(const char *str);
 
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
+        // Constructor that receives the identifier as the first length characters of str
+        ID(const char *str, std::size_t length);
+
+    private:
+        explicit ID(const symbols::Name &name);
     };
 
     /* Binary arithmetic operation */
@@ -140,10 +171,6 @@ namespace ast {
 
         // Constructor that receives the left and right operands and the operation
         BinOp(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right, BinOpType op);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Binary relational operation */
@@ -158,10 +185,6 @@ namespace ast {
 
         // Constructor that receives the left and right operands and the operation
         RelOp(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right, RelOpType op);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Unary logical NOT operation */
@@ -172,10 +195,6 @@ namespace ast {
 
         // Constructor that receives the operand
         explicit Not(std::shared_ptr<Exp> exp);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Binary logical AND operation */
@@ -188,10 +207,6 @@ namespace ast {
 
         // Constructor that receives the left and right operands
         And(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Binary logical OR operation */
@@ -204,10 +219,6 @@ namespace ast {
 
         // Constructor that receives the left and right operands
         Or(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Type symbol */
@@ -218,10 +229,6 @@ namespace ast {
 
         // Constructor that receives the type
         explicit Type(BuiltInType type);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Type cast */
@@ -234,10 +241,6 @@ namespace ast {
 
         // Constructor that receives the expression and the target type
         Cast(std::shared_ptr<Exp> exp, std::shared_ptr<Type> type);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* List of expressions */
@@ -247,7 +250,7 @@ namespace ast {
         std::vector<std::shared_ptr<Exp>> exps;
 
         // Constructor that receives no expressions
-        ExpList() = default;
+        ExpList();
 
         // Constructor that receives the first expression
         explicit ExpList(std::shared_ptr<Exp> exp);
@@ -257,29 +260,19 @@ namespace ast {
 
         // Method to add an expression at the end of the list
         void push_back(const std::shared_ptr<Exp> &exp);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Function call */
-    class Call : public Exp, public Statement {
+    class Call : public Exp {
     public:
         // Function identifier
         std::shared_ptr<ID> func_id;
         // List of arguments as expressions
         std::shared_ptr<ExpList> args;
 
-        // Constructor that receives the function identifier and the list of arguments
+        // Constructor that receives the function identifier and the list of arguments, which is empty for
+        // parameterless functions
         Call(std::shared_ptr<ID> func_id, std::shared_ptr<ExpList> args);
-
-        // Constructor that receives only the function identifier (for parameterless functions)
-        explicit Call(std::shared_ptr<ID> func_id);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* List of statements */
@@ -289,7 +282,7 @@ namespace ast {
         std::vector<std::shared_ptr<Statement>> statements;
 
         // Constructor that receives no statements
-        Statements() = default;
+        Statements();
 
         // Constructor that receives the first statement
         explicit Statements(std::shared_ptr<Statement> statement);
@@ -299,24 +292,18 @@ namespace ast {
 
         // Method to add a statement at the end of the list
         void push_back(const std::shared_ptr<Statement> &statement);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Break statement */
     class Break : public Statement {
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
+    public:
+        Break();
     };
 
     /* Continue statement */
     class Continue : public Statement {
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
+    public:
+        Continue();
     };
 
     /* Return statement */
@@ -327,10 +314,6 @@ namespace ast {
 
         // Constructor that receives the expression to be returned
         explicit Return(std::shared_ptr<Exp> exp = nullptr);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* If statement */
@@ -346,10 +329,6 @@ namespace ast {
         // Constructor that receives the condition, the statement to be executed if the condition is true, and the statement to be executed if the condition is false
         If(std::shared_ptr<Exp> condition, std::shared_ptr<Statement> then,
            std::shared_ptr<Statement> otherwise = nullptr);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* While statement */
@@ -362,10 +341,6 @@ namespace ast {
 
         // Constructor that receives the condition and the statement to be executed while the condition is true
         While(std::shared_ptr<Exp> condition, std::shared_ptr<Statement> body);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Variable declaration */
@@ -380,10 +355,6 @@ namespace ast {
 
         // Constructor that receives the identifier, the type, and the initial value expression
         VarDecl(std::shared_ptr<ID> id, std::shared_ptr<Type> type, std::shared_ptr<Exp> init_exp = nullptr);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Assignment statement */
@@ -396,10 +367,6 @@ namespace ast {
 
         // Constructor that receives the identifier and the expression to be assigned
         Assign(std::shared_ptr<ID> id, std::shared_ptr<Exp> exp);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Formal parameter */
@@ -412,10 +379,6 @@ namespace ast {
 
         // Constructor that receives the identifier and the type
         Formal(std::shared_ptr<ID> id, std::shared_ptr<Type> type);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* List of formal parameters */
@@ -425,7 +388,7 @@ namespace ast {
         std::vector<std::shared_ptr<Formal>> formals;
 
         // Constructor that receives no parameters
-        Formals() = default;
+        Formals();
 
         // Constructor that receives the first formal parameter
         explicit Formals(std::shared_ptr<Formal> formal);
@@ -435,10 +398,6 @@ namespace ast {
 
         // Method to add a formal parameter at the end of the list
         void push_back(const std::shared_ptr<Formal> &formal);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* Function declaration */
@@ -456,10 +415,6 @@ namespace ast {
         // Constructor that receives the identifier, the return type, the list of formal parameters, and the body
         FuncDecl(std::shared_ptr<ID> id, std::shared_ptr<Type> return_type, std::shared_ptr<Formals> formals,
                  std::shared_ptr<Statements> body);
-
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
-        }
     };
 
     /* List of function declarations */
@@ -469,7 +424,7 @@ namespace ast {
         std::vector<std::shared_ptr<FuncDecl>> funcs;
 
         // Constructor that receives no function declarations
-        Funcs() = default;
+        Funcs();
 
         // Constructor that receives the first function declaration
         explicit Funcs(std::shared_ptr<FuncDecl> func);
@@ -479,13 +434,92 @@ namespace ast {
 
         // Method to add a function declaration at the end of the list
         void push_back(const std::shared_ptr<FuncDecl> &func);
+    };
 
-        void accept(Visitor &visitor) override {
-            visitor.visit(*this);
+    // Defined here, where every class the switch casts to is complete
+    template<typename V>
+    void Node::accept(V &visitor) {
+        switch (kind) {
+            case Kind::NUM:
+                visitor.visit(static_cast<Num &>(*this));
+                break;
+            case Kind::NUM_B:
+                visitor.visit(static_cast<NumB &>(*this));
+                break;
+            case Kind::STRING:
+                visitor.visit(static_cast<String &>(*this));
+                break;
+            case Kind::BOOL:
+                visitor.visit(static_cast<Bool &>(*this));
+                break;
+            case Kind::ID:
+                visitor.visit(static_cast<ID &>(*this));
+                break;
+            case Kind::BIN_OP:
+                visitor.visit(static_cast<BinOp &>(*this));
+                break;
+            case Kind::REL_OP:
+                visitor.visit(static_cast<RelOp &>(*this));
+                break;
+            case Kind::NOT:
+                visitor.visit(static_cast<Not &>(*this));
+                break;
+            case Kind::AND:
+                visitor.visit(static_cast<And &>(*this));
+                break;
+            case Kind::OR:
+                visitor.visit(static_cast<Or &>(*this));
+                break;
+            case Kind::TYPE:
+                visitor.visit(static_cast<Type &>(*this));
+                break;
+            case Kind::CAST:
+                visitor.visit(static_cast<Cast &>(*this));
+                break;
+            case Kind::EXP_LIST:
+                visitor.visit(static_cast<ExpList &>(*this));
+                break;
+            case Kind::CALL:
+                visitor.visit(static_cast<Call &>(*this));
+                break;
+            case Kind::STATEMENTS:
+                visitor.visit(static_cast<Statements &>(*this));
+                break;
+            case Kind::BREAK:
+                visitor.visit(static_cast<Break &>(*this));
+                break;
+            case Kind::CONTINUE:
+                visitor.visit(static_cast<Continue &>(*this));
+                break;
+            case Kind::RETURN:
+                visitor.visit(static_cast<Return &>(*this));
+                break;
+            case Kind::IF:
+                visitor.visit(static_cast<If &>(*this));
+                break;
+            case Kind::WHILE:
+                visitor.visit(static_cast<While &>(*this));
+                break;
+            case Kind::VAR_DECL:
+                visitor.visit(static_cast<VarDecl &>(*this));
+                break;
+            case Kind::ASSIGN:
+                visitor.visit(static_cast<Assign &>(*this));
+                break;
+            case Kind::FORMAL:
+                visitor.visit(static_cast<Formal &>(*this));
+                break;
+            case Kind::FORMALS:
+                visitor.visit(static_cast<Formals &>(*this));
+                break;
+            case Kind::FUNC_DECL:
+                visitor.visit(static_cast<FuncDecl &>(*this));
+                break;
+            case Kind::FUNCS:
+                visitor.visit(static_cast<Funcs &>(*this));
+                break;
         }
-    };
+    }
 }
 
-#define YYSTYPE std::shared_ptr<ast::Node>
-
 #endif //NODES_HPP
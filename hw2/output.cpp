@@ -1,4 +1,6 @@
 #include "output.hpp"
+#include <charconv>
+#include <cstring>
 #include <iostream>
 
 namespace output {
@@ -9,7 +11,7 @@ namespace output {
 
     /* Helper functions */
 
-    static std::string toString(ast::BuiltInType type) {
+    static const char *toString(ast::BuiltInType type) {
         switch (type) {
             case ast::BuiltInType::INT:
                 return "int";
@@ -38,54 +40,207 @@ namespace output {
         exit(0);
     }
 
+    void errorNumTooLarge(int lineno, const std::string &value) {
+        std::cout << "line " << lineno << ": number " << value << " out of range\n";
+        exit(0);
+    }
+
     /* PrintVisitor implementation */
 
-    PrintVisitor::PrintVisitor() : indents({last_child_indent}), prefixes({last_child_prefix}) {}
+    PrintVisitor::PrintVisitor(Format format) : format(format), sink(stdout), levels({{true, 0, false}}) {}
 
-    void PrintVisitor::print_indented(const std::string &str) {
-        for (auto it = indents.begin(); it != indents.end() - 1; ++it) {
-            std::cout << *it;
+    PrintVisitor::~PrintVisitor() {
+        // Close the root, whose children were closed as they were left
+        if (printed && format != Format::TREE) {
+            leave_child();
+            sink.put('\n');
         }
-        std::cout << prefixes.back() << str << std::endl;
+    }
+
+    void PrintVisitor::print_indented(const char *label) {
+        print_node(label, nullptr, 0, false);
+    }
+
+    void PrintVisitor::print_indented(const char *label, std::string_view value) {
+        print_node(label, value.data(), value.size(), true);
+    }
+
+    void PrintVisitor::print_indented(const char *label, int value) {
+        char digits[16];
+        char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        print_node(label, digits, end - digits, false);
+    }
+
+    void PrintVisitor::print_node(const char *label, const char *value, std::size_t length, bool quoted) {
+        printed = true;
+        switch (format) {
+            case Format::TREE:
+                sink.write(indent);
+                sink.write(levels.back().last ? last_child_prefix : child_prefix);
+                sink.write(label, std::strlen(label));
+                if (value) {
+                    sink.write(": ", 2);
+                    sink.write(value, length);
+                }
+                sink.put('\n');
+                break;
+            case Format::JSON:
+                sink.write("{\"node\":\"", 9);
+                sink.write(label, std::strlen(label));
+                sink.put('"');
+                if (value) {
+                    sink.write(",\"value\":", 9);
+                    if (quoted) {
+                        print_quoted(value, length);
+                    } else {
+                        sink.write(value, length);
+                    }
+                }
+                sink.write(",\"children\":[", 13);
+                break;
+            case Format::SEXP:
+                sink.put('(');
+                sink.write(label, std::strlen(label));
+                if (value) {
+                    sink.put(' ');
+                    if (quoted) {
+                        print_quoted(value, length);
+                    } else {
+                        sink.write(value, length);
+                    }
+                }
+                break;
+        }
+    }
+
+    void PrintVisitor::print_quoted(const char *value, std::size_t length) {
+        static const char hex[] = "0123456789abcdef";
+        sink.put('"');
+        for (std::size_t i = 0; i < length; ++i) {
+            char c = value[i];
+            if (c == '"' || c == '\\') {
+                sink.put('\\');
+                sink.put(c);
+            } else if (format == Format::JSON && static_cast<unsigned char>(c) < 0x20) {
+                char escape[] = {'\\', 'u', '0', '0', hex[(c >> 4) & 0xf], hex[c & 0xf]};
+                sink.write(escape, sizeof(escape));
+            } else {
+                sink.put(c);
+            }
+        }
+        sink.put('"');
     }
 
     void PrintVisitor::enter_child() {
-        indents.emplace_back(child_indent);
-        prefixes.emplace_back(child_prefix);
+        enter(false);
     }
 
     void PrintVisitor::enter_last_child() {
-        indents.emplace_back(last_child_indent);
-        prefixes.emplace_back(last_child_prefix);
+        enter(true);
+    }
+
+    void PrintVisitor::enter(bool last) {
+        Level &parent = levels.back();
+        std::size_t length = indent.size();
+        switch (format) {
+            case Format::TREE:
+                indent += parent.last ? last_child_indent : child_indent;
+                break;
+            case Format::JSON:
+                if (parent.children) {
+                    sink.put(',');
+                }
+                break;
+            case Format::SEXP:
+                sink.put(' ');
+                break;
+        }
+        parent.children = true;
+        levels.push_back({last, length, false});
     }
 
     void PrintVisitor::leave_child() {
-        indents.pop_back();
-        prefixes.pop_back();
+        switch (format) {
+            case Format::TREE:
+                indent.resize(levels.back().indent);
+                break;
+            case Format::JSON:
+                sink.write("]}", 2);
+                break;
+            case Format::SEXP:
+                sink.put(')');
+                break;
+        }
+        levels.pop_back();
+    }
+
+    void PrintVisitor::print_child(ast::Node &child, bool last) {
+        pending.push_back({last ? Step::ENTER_LAST_CHILD : Step::ENTER_CHILD, nullptr});
+        pending.push_back({Step::VISIT, &child});
+        pending.push_back({Step::LEAVE_CHILD, nullptr});
+    }
+
+    template<typename T>
+    void PrintVisitor::print_children(const std::vector<std::shared_ptr<T>> &children, bool reversed) {
+        for (std::size_t i = 0; i < children.size(); ++i) {
+            print_child(*children[reversed ? children.size() - 1 - i : i], i + 1 == children.size());
+        }
+    }
+
+    void PrintVisitor::walk() {
+        if (walking) {
+            return;
+        }
+        walking = true;
+        tasks.insert(tasks.end(), pending.rbegin(), pending.rend());
+        pending.clear();
+        while (!tasks.empty()) {
+            Task task = tasks.back();
+            tasks.pop_back();
+            switch (task.step) {
+                case Step::VISIT:
+                    task.node->accept(*this);
+                    break;
+                case Step::ENTER_CHILD:
+                    enter_child();
+                    break;
+                case Step::ENTER_LAST_CHILD:
+                    enter_last_child();
+                    break;
+                case Step::LEAVE_CHILD:
+                    leave_child();
+                    break;
+            }
+            // The tasks of the visit go on top of the stack, its first task last, so they run before the tasks
+            // after it and in the order they were scheduled
+            tasks.insert(tasks.end(), pending.rbegin(), pending.rend());
+            pending.clear();
+        }
+        walking = false;
     }
 
     void PrintVisitor::visit(ast::Num &node) {
-        print_indented("Num: " + std::to_string(node.value));
+        print_indented("Num", node.value);
     }
 
     void PrintVisitor::visit(ast::NumB &node) {
-        print_indented("NumB: " + std::to_string(node.value));
+        print_indented("NumB", node.value);
     }
 
     void PrintVisitor::visit(ast::String &node) {
-        print_indented("String: " + node.value);
+        print_indented("String", node.value);
     }
 
     void PrintVisitor::visit(ast::Bool &node) {
-        print_indented("Bool: " + std::string((node.value ? "true" : "false")));
+        print_node("Bool", node.value ? "true" : "false", node.value ? 4 : 5, false);
     }
 
     void PrintVisitor::visit(ast::ID &node) {
-        print_indented("ID: " + node.value);
+        print_indented("ID", node.value);
     }
 
     void PrintVisitor::visit(ast::BinOp &node) {
-        std::string op;
+        const char *op = "";
 
         switch (node.op) {
             case ast::BinOpType::ADD:
@@ -102,19 +257,16 @@ namespace output {
                 break;
         }
 
-        print_indented("BinOp: " + op);
+        print_node("BinOp", op, std::strlen(op), true);
 
-        enter_child();
-        node.left->accept(*this);
-        leave_child();
+        print_child(*node.left, false);
+        print_child(*node.right, true);
 
-        enter_last_child();
-        node.right->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::RelOp &node) {
-        std::string op;
+        const char *op = "";
 
         switch (node.op) {
             case ast::RelOpType::EQ:
@@ -137,104 +289,76 @@ namespace output {
                 break;
         }
 
-        print_indented("RelOp: " + op);
-
-        enter_child();
-        node.left->accept(*this);
-        leave_child();
+        print_node("RelOp", op, std::strlen(op), true);
 
+        print_child(*node.left, false);
+        print_child(*node.right, true);
 
-        enter_last_child();
-        node.right->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::Type &node) {
-        print_indented("Type: " + toString(node.type));
+        print_node("Type", toString(node.type), std::strlen(toString(node.type)), true);
     }
 
     void PrintVisitor::visit(ast::Cast &node) {
         print_indented("Cast");
 
-        enter_child();
-        node.exp->accept(*this);
-        leave_child();
+        print_child(*node.exp, false);
+        print_child(*node.target_type, true);
 
-        enter_last_child();
-        node.target_type->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::Not &node) {
         print_indented("Not");
 
-        enter_last_child();
-        node.exp->accept(*this);
-        leave_child();
+        print_child(*node.exp, true);
+
+        walk();
     }
 
     void PrintVisitor::visit(ast::And &node) {
         print_indented("And");
 
-        enter_child();
-        node.left->accept(*this);
-        leave_child();
+        print_child(*node.left, false);
+        print_child(*node.right, true);
 
-        enter_last_child();
-        node.right->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::Or &node) {
         print_indented("Or");
 
-        enter_child();
-        node.left->accept(*this);
-        leave_child();
+        print_child(*node.left, false);
+        print_child(*node.right, true);
 
-        enter_last_child();
-        node.right->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::ExpList &node) {
         print_indented("ExpList");
 
-        for (auto it = node.exps.rbegin(); it != node.exps.rend(); ++it) {
-            if (it != node.exps.rend() - 1) {
-                enter_child();
-            } else {
-                enter_last_child();
-            }
-            (*it)->accept(*this);
-            leave_child();
-        }
+        print_children(node.exps, format == Format::TREE);
+
+        walk();
     }
 
     void PrintVisitor::visit(ast::Call &node) {
         print_indented("Call");
 
-        enter_child();
-        node.func_id->accept(*this);
-        leave_child();
+        print_child(*node.func_id, false);
+        print_child(*node.args, true);
 
-        enter_last_child();
-        node.args->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::Statements &node) {
         print_indented("Statements");
 
-        for (auto it = node.statements.begin(); it != node.statements.end(); ++it) {
-            if (it != node.statements.end() - 1) {
-                enter_child();
-            } else {
-                enter_last_child();
-            }
-            (*it)->accept(*this);
-            leave_child();
-        }
+        print_children(node.statements, false);
+
+        walk();
     }
 
     void PrintVisitor::visit(ast::Break &node) {
@@ -249,137 +373,89 @@ namespace output {
         print_indented("Return");
 
         if (node.exp) {
-            enter_last_child();
-            node.exp->accept(*this);
-            leave_child();
+            print_child(*node.exp, true);
         }
+
+        walk();
     }
 
     void PrintVisitor::visit(ast::If &node) {
         print_indented("If");
 
-        enter_child();
-        node.condition->accept(*this);
-        leave_child();
+        print_child(*node.condition, false);
+        print_child(*node.then, !node.otherwise);
 
         if (node.otherwise) {
-            enter_child();
-        } else {
-            enter_last_child();
+            print_child(*node.otherwise, true);
         }
-        node.then->accept(*this);
-        leave_child();
 
-        if (node.otherwise) {
-            enter_last_child();
-            node.otherwise->accept(*this);
-            leave_child();
-        }
+        walk();
     }
 
     void PrintVisitor::visit(ast::While &node) {
         print_indented("While");
 
-        enter_child();
-        node.condition->accept(*this);
-        leave_child();
+        print_child(*node.condition, false);
+        print_child(*node.body, true);
 
-        enter_last_child();
-        node.body->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::VarDecl &node) {
         print_indented("VarDecl");
 
-        enter_child();
-        node.id->accept(*this);
-        leave_child();
+        print_child(*node.id, false);
+        print_child(*node.type, !node.init_exp);
 
         if (node.init_exp) {
-            enter_child();
-        } else {
-            enter_last_child();
+            print_child(*node.init_exp, true);
         }
-        node.type->accept(*this);
-        leave_child();
 
-        if (node.init_exp) {
-            enter_last_child();
-            node.init_exp->accept(*this);
-            leave_child();
-        }
+        walk();
     }
 
     void PrintVisitor::visit(ast::Assign &node) {
         print_indented("Assign");
 
-        enter_child();
-        node.id->accept(*this);
-        leave_child();
+        print_child(*node.id, false);
+        print_child(*node.exp, true);
 
-        enter_last_child();
-        node.exp->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::Formal &node) {
         print_indented("Formal");
 
-        enter_child();
-        node.id->accept(*this);
-        leave_child();
+        print_child(*node.id, false);
+        print_child(*node.type, true);
 
-        enter_last_child();
-        node.type->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::Formals &node) {
         print_indented("Formals");
 
-        for (auto it = node.formals.rbegin(); it != node.formals.rend(); ++it) {
-            if (it != node.formals.rend() - 1) {
-                enter_child();
-            } else {
-                enter_last_child();
-            }
-            (*it)->accept(*this);
-            leave_child();
-        }
+        print_children(node.formals, format == Format::TREE);
+
+        walk();
     }
 
     void PrintVisitor::visit(ast::FuncDecl &node) {
         print_indented("FuncDecl");
 
-        enter_child();
-        node.id->accept(*this);
-        leave_child();
-
-        enter_child();
-        node.return_type->accept(*this);
-        leave_child();
+        print_child(*node.id, false);
+        print_child(*node.return_type, false);
+        print_child(*node.formals, false);
+        print_child(*node.body, true);
 
-        enter_child();
-        node.formals->accept(*this);
-        leave_child();
-
-        enter_last_child();
-        node.body->accept(*this);
-        leave_child();
+        walk();
     }
 
     void PrintVisitor::visit(ast::Funcs &node) {
         print_indented("Funcs");
 
-        for (auto it = node.funcs.begin(); it != node.funcs.end(); ++it) {
-            if (it != node.funcs.end() - 1) {
-                enter_child();
-            } else {
-                enter_last_child();
-            }
-            (*it)->accept(*this);
-            leave_child();
-        }
+        print_children(node.funcs, false);
+
+        walk();
     }
 }
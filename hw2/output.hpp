@@ -1,10 +1,14 @@
 #ifndef OUTPUT_HPP
 #define OUTPUT_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
 #include "visitor.hpp"
 #include "nodes.hpp"
+#include "../scanner/sink.hpp"
 
 namespace output {
     /* Error handling functions */
@@ -13,27 +17,91 @@ namespace output {
 
     void errorSyn(int lineno);
 
+    void errorNumTooLarge(int lineno, const std::string &value);
+
+
+    /* Output formats of the PrintVisitor */
+    enum class Format {
+        TREE, // The indented tree, the default
+        JSON, // One object per node: {"node":"BinOp","value":"+","children":[...]}
+        SEXP  // One list per node: (BinOp "+" ...)
+    };
 
     /* PrintVisitor class
-     * This class is used to print the AST in a human-readable format.
+     * This class is used to print the AST in a human-readable format, or as JSON or S-expressions for other tools.
+     * The output is streamed to stdout and is complete once the visitor is destroyed.
      */
-    class PrintVisitor : public Visitor {
+    class PrintVisitor final : public Visitor {
     private:
-        std::vector<std::string> indents;
-        std::vector<std::string> prefixes;
-
-        /* Helper function to print a string with the current indentation */
-        void print_indented(const std::string &str);
+        // Where the current node sits: whether it is the last child of its parent, the length of the tree
+        // indentation before it was entered, and whether it has printed a child yet
+        struct Level {
+            bool last;
+            std::size_t indent;
+            bool children;
+        };
+
+        /* The tree is walked with an explicit stack instead of recursing through accept, so the depth of a
+         * program is limited only by memory. A visit prints its node and schedules its children, each entered,
+         * visited and left; walk() runs the scheduled tasks, the tasks of one visit in the order it scheduled them */
+        enum class Step : std::uint8_t {
+            VISIT,
+            ENTER_CHILD,
+            ENTER_LAST_CHILD,
+            LEAVE_CHILD
+        };
+
+        struct Task {
+            Step step;
+            ast::Node *node;
+        };
+
+        Format format;
+        sink::Sink sink;
+        // The indentation of the current line of the tree, grown and shrunk as children are entered and left
+        std::string indent;
+        std::vector<Level> levels;
+        bool printed = false;
+        // The tasks still to run, the next one last, and the tasks the running one has scheduled so far
+        std::vector<Task> tasks;
+        std::vector<Task> pending;
+        bool walking = false;
+
+        /* Helper functions to print a node with the current indentation, by its label and optional value */
+        void print_indented(const char *label);
+
+        void print_indented(const char *label, std::string_view value);
+
+        void print_indented(const char *label, int value);
+
+        void print_node(const char *label, const char *value, std::size_t length, bool quoted);
+
+        void print_quoted(const char *value, std::size_t length);
 
         /* Functions to manage the indentation level */
         void enter_child();
 
         void enter_last_child();
 
+        void enter(bool last);
+
         void leave_child();
 
+        /* Schedules a node to be printed as a child, the last child of its parent if last is set */
+        void print_child(ast::Node &child, bool last);
+
+        /* Schedules each node of a list to be printed as a child. The tree format lists them last to first */
+        template<typename T>
+        void print_children(const std::vector<std::shared_ptr<T>> &children, bool reversed);
+
+        /* Runs the scheduled tasks until none is left. Does nothing when called from a task, since the loop that
+         * runs that task picks up what it scheduled */
+        void walk();
+
     public:
-        PrintVisitor();
+        explicit PrintVisitor(Format format = Format::TREE);
+
+        ~PrintVisitor();
 
         void visit(ast::Num &node) override;
 
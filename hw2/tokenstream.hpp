@@ -0,0 +1,74 @@
+#ifndef TOKENSTREAM_HPP
+#define TOKENSTREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../scanner/scanner.hpp"
+#include "parser.tab.h"
+
+namespace tokenstream {
+
+    /* Reads the binary token stream hw1 writes with --emit-tokens=binary (the format is described in
+     * hw1/tokenstream.hpp), so the parser can run without lexing the source again */
+    class Reader {
+    private:
+        std::string data;
+        std::size_t position = 0;
+        // Views into data, which is kept for the life of the reader, so the nodes can point into it too
+        std::vector<std::string_view> lexemes;
+        std::string_view lexeme;
+        int line = 1;
+        bool error = false;
+        bool ended = false; // The END record was read
+        bool broken = false; // The stream is cut short or does not follow the format
+
+        // Reads a varint, or sets broken if the stream ends inside it
+        std::uint64_t varint();
+
+        // Marks the stream broken and ends it
+        scanner::Token refuse();
+
+    public:
+        /* loads a whole stream. Returns false if the file cannot be read or does not hold a well-formed token stream
+         * of the current version: one that is cut short, refers to a lexeme it has not defined, has a lexeme running
+         * past its end, or has a number or string the PARSER dialect does not match */
+        bool open(const char *path);
+
+        /* returns the next token, numbered as scanner::Token, or Token::END after the last one */
+        scanner::Token next();
+
+        int lineno() const;
+
+        /* raw source text of the last ID, NUM, NUM_B, STRING, RELOP or BINOP token */
+        std::string_view text() const;
+
+        /* true once the stream ended on a lexical error */
+        bool failed() const;
+    };
+
+    /* Where the parser takes its tokens from: the shared scanner or a loaded token stream. Holds all the lexer
+     * state of one parse, which yylex() gets from the parser as its lex parameter */
+    class Source {
+    private:
+        scanner::Scanner *scanner = nullptr;
+        Reader *reader = nullptr;
+
+        /* text of the last token, a view into the scanned source or the loaded stream */
+        std::string_view text() const;
+
+    public:
+        explicit Source(scanner::Scanner &scanner);
+
+        explicit Source(Reader &reader);
+
+        /* returns the next token of the grammar, with the node of an ID, NUM, NUM_B or STRING, allocated in arena,
+         * in value. A STRING node points into the text of its token, so the scanned source or the reader must
+         * outlive the AST */
+        int next(yy::parser::value_type &value, ast::Arena &arena);
+    };
+}
+
+#endif //TOKENSTREAM_HPP
@@ -0,0 +1,29 @@
+#ifndef FLAT_HPP
+#define FLAT_HPP
+
+#include <memory>
+#include "nodes.hpp"
+#include "../scanner/arena.hpp"
+#include "../scanner/fcas.hpp"
+
+/* The flat form of the AST is the serialization format of --emit-ast and --load-ast, and nothing else. The parser
+ * builds the pointer AST and the visitors walk it. lower() turns that AST into a Tree for save(), and inflate()
+ * rebuilds it from a loaded file. The file itself is read and written by scanner/fcas.hpp */
+namespace flat {
+
+    static_assert(sizeof(ast::Kind) == sizeof(Tag), "a flat node stores its ast::Kind in a Tag");
+
+    /* The nodes of hw3. The children of a node are in the order of the members of its class in nodes.hpp (a
+     * FuncDecl has its id, return type, formals and body). The payload is the value of a NUM, NUM_B or BOOL, the
+     * text of an ID or STRING, the operator of a BIN_OP or REL_OP, the BuiltInType of a TYPE, and 1 for a
+     * STATEMENTS written in braces. It is 0 for the other kinds */
+    extern const Grammar GRAMMAR;
+
+    /* Flattens the AST rooted at program into tree and returns the index of its root */
+    Index lower(ast::Node &program, Tree &tree);
+
+    /* Rebuilds the AST of tree in arena, so any Visitor (PrintVisitor, ScopePrinter) can walk a flat tree */
+    std::shared_ptr<ast::Node> inflate(const View &tree, ast::Arena &arena);
+}
+
+#endif //FLAT_HPP
@@ -1,20 +1,122 @@
-#include <iostream>
-#include "nodes.hpp"
-#include "output.hpp"
-
-// Extern from the bison-generated parser
-extern int yyparse();
-
-extern std::shared_ptr<ast::Node> program;
-
-int main() {
-    try {
-        yyparse(); // Call the parser function
-        output::ScopePrinter scopePrinter;
-        program->accept(scopePrinter);
-    } catch (const std::exception &e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return 1;
-    }
-    return 0;
-}
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "nodes.hpp"
+#include "tokenstream.hpp"
+#include "../scanner/arena.hpp"
+#include "flat.hpp"
+#include "../scanner/input.hpp"
+#include "../scanner/stats.hpp"
+#include "output.hpp"
+
+// The bison-generated parser
+#include "parser.tab.h"
+
+/* The count --jobs asks for, at most one job per core. Returns 0 unless text is a positive decimal number */
+static unsigned jobCount(const char *text) {
+    char *end;
+    unsigned long jobs = std::strtoul(text, &end, 10);
+    if (!(*text >= '0' && *text <= '9') || *end != '\0' || jobs == 0) {
+        return 0;
+    }
+    unsigned long cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        cores = UINT_MAX; // The core count is unknown
+    }
+    return static_cast<unsigned>(jobs < cores ? jobs : cores);
+}
+
+int main(int argc, char *argv[]) {
+    tokenstream::Reader tokens;
+    bool stream = false;
+    const char *emitPath = nullptr;
+    const char *loadPath = nullptr;
+    unsigned jobs = 1;
+
+    // --tokens <file> parses a token stream written by hw1 --emit-tokens=binary instead of scanning stdin
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--tokens") == 0 && i + 1 < argc) {
+            if (!tokens.open(argv[++i])) {
+                std::cerr << "Error: cannot read token stream " << argv[i] << std::endl;
+                return 1;
+            }
+            stream = true;
+        } else if (std::strcmp(argv[i], "--lex-stats") == 0) {
+            if (!stats::available) {
+                std::cerr << "Error: --lex-stats needs a build with -DLEX_STATS" << std::endl;
+                return 1;
+            }
+            stats::enable();
+        } else if (std::strncmp(argv[i], "--emit-ast=", 11) == 0) {
+            // Also writes the parsed program to a binary AST file
+            emitPath = argv[i] + 11;
+        } else if (std::strncmp(argv[i], "--load-ast=", 11) == 0) {
+            // Checks a program loaded from a binary AST file instead of parsing stdin
+            loadPath = argv[i] + 11;
+        } else if (std::strncmp(argv[i], "--diagnostics=", 14) == 0) {
+            // --diagnostics=first|text|json picks whether checking stops at the first error, and how errors are printed
+            const char *name = argv[i] + 14;
+            if (std::strcmp(name, "first") == 0) {
+                output::reportDiagnostics(output::Diagnostics::FIRST);
+            } else if (std::strcmp(name, "text") == 0) {
+                output::reportDiagnostics(output::Diagnostics::TEXT);
+            } else if (std::strcmp(name, "json") == 0) {
+                output::reportDiagnostics(output::Diagnostics::JSON);
+            } else {
+                std::cerr << "Error: unknown diagnostics format " << name << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            // Checks the function bodies on this many threads
+            if (!(jobs = jobCount(argv[++i]))) {
+                std::cerr << "Error: --jobs needs a positive number, not " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    ast::Arena arena; // Owns every node of the AST
+    input::Buffer buffer; // The source read from stdin, which string nodes point into, kept until the end
+    std::shared_ptr<ast::Node> program;
+    flat::Mapping mapping;
+
+    try {
+        if (loadPath) {
+            if (!mapping.open(loadPath, flat::GRAMMAR)) {
+                std::cerr << "Error: cannot load AST " << loadPath << std::endl;
+                return 1;
+            }
+            program = flat::inflate(mapping.view(), arena);
+        } else {
+            std::unique_ptr<scanner::Scanner> scanner;
+            if (!stream) {
+                if (!input::load(stdin, buffer)) {
+                    std::cerr << "Error: cannot read the input" << std::endl;
+                    return 1;
+                }
+                scanner = std::make_unique<scanner::Scanner>(buffer.data, buffer.size, scanner::Dialect::PARSER);
+            }
+            tokenstream::Source source = stream ? tokenstream::Source(tokens) : tokenstream::Source(*scanner);
+            yy::parser parser(source, arena, program);
+            parser.parse(); // Call the parser function
+        }
+        if (emitPath) {
+            flat::Tree tree;
+            flat::lower(*program, tree);
+            if (!flat::save(tree, flat::GRAMMAR, emitPath)) {
+                std::cerr << "Error: cannot write AST " << emitPath << std::endl;
+                return 1;
+            }
+        }
+        output::ScopePrinter scopePrinter(jobs);
+        program->accept(scopePrinter);
+    } catch (const std::exception &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    input::release(buffer);
+    return 0;
+}
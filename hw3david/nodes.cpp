@@ -2,47 +2,53 @@
 #include <string>
 #include <utility>
 
-extern int yylineno;
+extern thread_local int yylineno;
 
 namespace ast {
 
-    Exp::Exp(BuiltInType B) : type(B) {}
+    Node::Node(Kind kind) : kind(kind), line(yylineno) {}
 
-    Node::Node() : line(yylineno) {}
+    Statement::Statement(Kind kind) : Node(kind) {}
 
-    Num::Num(const char *str) : Exp(), value(std::stoi(str)) {}
+    Exp::Exp(Kind kind, BuiltInType B) : Statement(kind), type(B) {}
 
-    NumB::NumB(const char *str) : Exp(), value(std::stoi(str)) {}
+    Num::Num(int value) : Exp(Kind::NUM), value(value) {}
 
-    String::String(const char *str) : Exp(), value(str) {
-        // Remove the quotes
-        value = value.substr(1, value.size() - 2);
-    }
+    NumB::NumB(int value) : Exp(Kind::NUM_B), value(value) {}
+
+    // Leave out the quotes
+    String::String(const char *str, std::size_t length) : Exp(Kind::STRING), value(str + 1, length - 2) {}
+
+    Bool::Bool(bool value) : Exp(Kind::BOOL, BuiltInType::STRING), value(value) {}
 
-    Bool::Bool(bool value) : Exp(BuiltInType::STRING), value(value) {}
+    ID::ID(const char *str) : ID(symbols::intern(str)) {}
 
-    ID::ID(const char *str) : Exp(), value(str) {}
+    ID::ID(const char *str, std::size_t length) : ID(symbols::intern(str, length)) {}
+
+    ID::ID(const symbols::Name &name) : Exp(Kind::ID), symbol(name.symbol), hash(name.hash), value(name.text) {}
 
     BinOp::BinOp(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right, BinOpType op)
-            : Exp(), left(std::move(left)), right(std::move(right)), op(op) {}
+            : Exp(Kind::BIN_OP), left(std::move(left)), right(std::move(right)), op(op) {}
 
     RelOp::RelOp(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right, RelOpType op)
-            : Exp(), left(std::move(left)), right(std::move(right)), op(op) {}
+            : Exp(Kind::REL_OP), left(std::move(left)), right(std::move(right)), op(op) {}
 
-    Type::Type(BuiltInType type) : Node(), type(type) {}
+    Type::Type(BuiltInType type) : Node(Kind::TYPE), type(type) {}
 
     Cast::Cast(std::shared_ptr<Exp> exp, std::shared_ptr<Type> target_type)
-            : Exp(), exp(std::move(exp)), target_type(std::move(target_type)) {}
+            : Exp(Kind::CAST), exp(std::move(exp)), target_type(std::move(target_type)) {}
 
-    Not::Not(std::shared_ptr<Exp> exp) : Exp(), exp(std::move(exp)) {}
+    Not::Not(std::shared_ptr<Exp> exp) : Exp(Kind::NOT), exp(std::move(exp)) {}
 
     And::And(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right)
-            : Exp(), left(std::move(left)), right(std::move(right)) {}
+            : Exp(Kind::AND), left(std::move(left)), right(std::move(right)) {}
 
     Or::Or(std::shared_ptr<Exp> left, std::shared_ptr<Exp> right)
-            : Exp(), left(std::move(left)), right(std::move(right)) {}
+            : Exp(Kind::OR), left(std::move(left)), right(std::move(right)) {}
+
+    ExpList::ExpList() : Node(Kind::EXP_LIST) {}
 
-    ExpList::ExpList(std::shared_ptr<Exp> exp) : Node(), exps({std::move(exp)}) {}
+    ExpList::ExpList(std::shared_ptr<Exp> exp) : Node(Kind::EXP_LIST), exps({std::move(exp)}) {}
 
     void ExpList::push_front(const std::shared_ptr<Exp> &exp) {
         exps.insert(exps.begin(), exp);
@@ -53,12 +59,12 @@ namespace ast {
     }
 
     Call::Call(std::shared_ptr<ID> func_id, std::shared_ptr<ExpList> args)
-            : Exp(), func_id(std::move(func_id)), args(std::move(args)) {}
+            : Exp(Kind::CALL), func_id(std::move(func_id)), args(std::move(args)) {}
 
-    Call::Call(std::shared_ptr<ID> func_id)
-            : Exp(), func_id(std::move(func_id)), args(std::make_shared<ExpList>()) {}
+    Statements::Statements() : Statement(Kind::STATEMENTS) {}
 
-    Statements::Statements(std::shared_ptr<Statement> statement) : Statement(), statements({std::move(statement)}) {}
+    Statements::Statements(std::shared_ptr<Statement> statement)
+            : Statement(Kind::STATEMENTS), statements({std::move(statement)}) {}
 
     void Statements::push_front(const std::shared_ptr<Statement> &statement) {
         statements.insert(statements.begin(), statement);
@@ -68,32 +74,40 @@ namespace ast {
         statements.push_back(statement);
     }
 
-    Return::Return(std::shared_ptr<Exp> exp) : Statement(), exp(std::move(exp)) {}
+    Break::Break() : Statement(Kind::BREAK) {}
+
+    Continue::Continue() : Statement(Kind::CONTINUE) {}
+
+    Return::Return(std::shared_ptr<Exp> exp) : Statement(Kind::RETURN), exp(std::move(exp)) {}
 
     If::If(std::shared_ptr<Exp> condition, std::shared_ptr<Statement> then, std::shared_ptr<Statement> otherwise)
-            : Statement(), condition(std::move(condition)), then(std::move(then)), otherwise(std::move(otherwise)) {}
+            : Statement(Kind::IF), condition(std::move(condition)), then(std::move(then)),
+              otherwise(std::move(otherwise)) {}
 
     While::While(std::shared_ptr<Exp> condition, std::shared_ptr<Statement> body)
-            : Statement(), condition(std::move(condition)),
+            : Statement(Kind::WHILE), condition(std::move(condition)),
               body(std::move(body)) {}
 
     VarDecl::VarDecl(std::shared_ptr<ID> id, std::shared_ptr<Type> type, std::shared_ptr<Exp> init_exp)
-            : Statement(), id(std::move(std::move(id))), type(std::move(type)), init_exp(std::move(init_exp)) {}
+            : Statement(Kind::VAR_DECL), id(std::move(std::move(id))), type(std::move(type)),
+              init_exp(std::move(init_exp)) {}
 
     Assign::Assign(std::shared_ptr<ID> id, std::shared_ptr<Exp> exp)
-            : Statement(), id(std::move(id)), exp(std::move(exp)) {}
+            : Statement(Kind::ASSIGN), id(std::move(id)), exp(std::move(exp)) {}
 
     ArrayAssign::ArrayAssign(std::shared_ptr<ID> id, std::shared_ptr<Exp> index, std::shared_ptr<Exp> value)
-            : Statement(), id(std::move(id)), index(std::move(index)), value(std::move(value)) {}
+            : Statement(Kind::ARRAY_ASSIGN), id(std::move(id)), index(std::move(index)), value(std::move(value)) {}
     ArrayDecl::ArrayDecl(std::shared_ptr<ID> id, std::shared_ptr<Type> type, std::shared_ptr<Exp> size)
-            : Statement(), id(std::move(id)), type(std::move(type)), size(std::move(size)) {}
+            : Statement(Kind::ARRAY_DECL), id(std::move(id)), type(std::move(type)), size(std::move(size)) {}
     ArrayAccess::ArrayAccess(std::shared_ptr<ID> id, std::shared_ptr<Exp> index)
-            : Exp(), id(std::move(id)), index(std::move(index)) {}
+            : Exp(Kind::ARRAY_ACCESS), id(std::move(id)), index(std::move(index)) {}
             
     Formal::Formal(std::shared_ptr<ID> id, std::shared_ptr<Type> type)
-            : Node(), id(std::move(id)), type(std::move(type)) {}
+            : Node(Kind::FORMAL), id(std::move(id)), type(std::move(type)) {}
+
+    Formals::Formals() : Node(Kind::FORMALS) {}
 
-    Formals::Formals(std::shared_ptr<Formal> formal) : Node(), formals({std::move(formal)}) {}
+    Formals::Formals(std::shared_ptr<Formal> formal) : Node(Kind::FORMALS), formals({std::move(formal)}) {}
 
     void Formals::push_front(const std::shared_ptr<Formal> &formal) {
         formals.insert(formals.begin(), formal);
@@ -105,10 +119,12 @@ namespace ast {
 
     FuncDecl::FuncDecl(std::shared_ptr<ID> id, std::shared_ptr<Type> return_type, std::shared_ptr<Formals> formals,
                        std::shared_ptr<Statements> body)
-            : Node(), id(std::move(id)), return_type(std::move(return_type)), formals(std::move(formals)),
-              body(std::move(body)) {}
+            : Node(Kind::FUNC_DECL), id(std::move(id)), return_type(std::move(return_type)),
+              formals(std::move(formals)), body(std::move(body)) {}
+
+    Funcs::Funcs() : Node(Kind::FUNCS) {}
 
-    Funcs::Funcs(std::shared_ptr<FuncDecl> func) : Node(), funcs({std::move(func)}) {}
+    Funcs::Funcs(std::shared_ptr<FuncDecl> func) : Node(Kind::FUNCS), funcs({std::move(func)}) {}
 
     void Funcs::push_front(const std::shared_ptr<FuncDecl> &func) {
         funcs.insert(funcs.begin(), func);
@@ -3,146 +3,325 @@
 // It allows input-output stream operations, such as using `std::cout` to print output 
 // or `std::cin` to read input from the user.
 
-#include <algorithm>
- // The <algorithm> header provides standard algorithms that operate on containers.
-// For example, `std::find_if`, which is used to search for elements in a range that satisfy a given condition.
+#include <atomic>
+ // The <atomic> header provides atomic counters, which the threads that check functions in parallel share.
+
+#include <charconv>
+ // <charconv> reads back the indentation level marked in front of each line of the scopes.
+
+#include <exception>
+#include <thread>
+ // <thread> starts those threads, and <exception> carries an unexpected failure of one back to the main thread.
 
 #include "output.hpp"
  // This is a custom header file, which declares various functions, classes, and variables related 
 // to semantic analysis, error reporting, and scope printing for a compiler's intermediate representation.
 
-#define CAST_TO_FORMAL(mishtane) std::dynamic_pointer_cast < ast::Formal > (mishtane)
-// This macro simplifies the repetitive task of casting a `std::shared_ptr<ast::Node>` 
-// to `std::shared_ptr<ast::Formal>` using `std::dynamic_pointer_cast`. It takes a single argument, `mishtane` 
-// (Hebrew for "variable").
-
-#define CAST_TO_VARDECL(mishtane) std::dynamic_pointer_cast < ast::VarDecl > (mishtane)
-// Similarly, this macro casts a `std::shared_ptr<ast::Node>` to a `std::shared_ptr<ast::VarDecl>`.
-
 namespace output {
     // All the functionality defined here is encapsulated in the `output` namespace. 
     // This helps organize code and avoid name conflicts with other parts of the program.
 
+    // The state of the checker below is thread_local, so programs on different threads are checked independently.
+
     // Declaring a global vector to track variables within the current scope.
-    std::vector < std::shared_ptr < ast::Node >> mishtaneMisgeret;
-    // Each element in this vector represents a variable or formal parameter 
-    // (wrapped as `std::shared_ptr<ast::Node>`), enabling efficient scope management.
+    thread_local std::vector < Mishtane > mishtaneMisgeret;
+    // Each element in this vector represents a variable or formal parameter, with its name and type,
+    // in the order they were declared.
+
+    // The symbol table: maps the symbol of a name to the index of its innermost entry in `mishtaneMisgeret`.
+    thread_local std::unordered_map < symbols::Symbol, int > tavlatSmalim;
+    // Looking a name up is a single hash lookup, instead of a scan of every variable in scope.
 
     // Keeps track of the number of variables in each active scope.
-    std::vector < int > MisparMishtaneNokhehi;
+    thread_local std::vector < int > MisparMishtaneNokhehi;
     // For each scope, the last element indicates how many variables are defined. 
     // This is used during scope cleanup to remove all variables introduced in a scope.
 
-    // Stores globally defined functions, represented as `ast::FuncDecl`.
-    std::vector < std::shared_ptr < ast::FuncDecl >> HatsharatMishtaneGlobali;
+    // Stores globally defined functions, each with its return type and parameter types.
+    thread_local std::vector < Funktsiyya > HatsharatMishtaneGlobali;
+
+    // The function table: maps the symbol of a function's name to its index in `HatsharatMishtaneGlobali`.
+    thread_local std::unordered_map < symbols::Symbol, int > tavlatFunktsiyyot;
 
     // Tracks nodes associated with global variable usage or function calls.
-    std::vector < std::shared_ptr < ast::Node >> KriatMishtaneGlobali;
+    thread_local std::vector < std::shared_ptr < ast::Node >> KriatMishtaneGlobali;
 
     // Tracks the return type of the current function being analyzed.
-    ast::BuiltInType returnType;
+    thread_local ast::BuiltInType returnType;
 
     // Boolean flag to indicate whether the current operation involves a function call.
-    bool zoKria = false;
+    thread_local bool zoKria = false;
 
     // Boolean flag to indicate whether variables are in use or not.
-    bool shimush = true;
+    thread_local bool shimush = true;
 
     // Tracks the total number of variables declared, used for offset calculations.
-    int moneMishtanim = 0;
+    thread_local int moneMishtanim = 0;
 
-    // ScopePrinter::visit(ast::Funcs&)
-    // This method processes the `Funcs` node in the Abstract Syntax Tree (AST),
-    // which represents a collection of function declarations.
-    void ScopePrinter::visit(ast::Funcs & node) {
-        // Initialize the built-in `print` function.
-        std::shared_ptr < ast::ID > mezaheHadpasa = std::make_shared < ast::ID > ("print");
-        // Creates a new identifier node for the function name "print".
+    // How errors are reported. It is set once before checking starts, so every thread reads the same mode.
+    static Diagnostics ofenDivuakh = Diagnostics::FIRST;
+
+    // The errors collected on this thread, in the order they were found, when every error is reported.
+    thread_local std::vector < Diagnostic > divuakhim;
+
+    // An error found on a thread that checks functions in parallel, thrown back to the thread that reports it.
+    struct Shgia {
+        Diagnostic divuakh;
+    };
+
+    // Set on the threads that check functions in parallel, where errors are thrown instead of reported.
+    thread_local bool bodekMakbil = false;
+
+    static void dovakh(Diagnostic divuakh) {
+        // Report an error. When every error is reported, collect it and let the checker go on. Otherwise print it
+        // and exit the program, or hand it back when checking in parallel, so that only the first error in source
+        // order is reported.
+        if (ofenDivuakh != Diagnostics::FIRST) {
+            divuakhim.push_back(std::move(divuakh));
+            return;
+        }
+        if (bodekMakbil) {
+            throw Shgia {std::move(divuakh)};
+        }
+        std::cout << divuakh;
+        exit(0); // Exit the program as the error is critical.
+    }
+
+    void reportDiagnostics(Diagnostics mode) {
+        ofenDivuakh = mode;
+    }
+
+    std::ostream & operator << (std::ostream & os,
+        const Diagnostic & divuakh) {
+        // Errors of the whole program, such as a missing main, have no line.
+        if (divuakh.line > 0) {
+            os << "line " << divuakh.line << ": ";
+        }
+        return os << divuakh.message << std::endl;
+    }
 
-        std::shared_ptr < ast::Type > tippusHahzaratHadpasa = std::make_shared < ast::Type > (ast::BuiltInType::VOID);
-        // Specifies that the `print` function has a return type of `void`.
+    static void hadpasatJson(std::ostream & os,
+        const std::string & text) {
+        // Print the text as a JSON string, escaping quotes, backslashes and control characters.
+        static const char hex[] = "0123456789abcdef";
+        os << '"';
+        for (char c: text) {
+            if (c == '"' || c == '\\') {
+                os << '\\' << c;
+            } else if (static_cast < unsigned char > (c) < 0x20) {
+                os << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+            } else {
+                os << c;
+            }
+        }
+        os << '"';
+    }
 
-        std::shared_ptr < ast::ID > mezaheFormaliHadpasa = std::make_shared < ast::ID > ("var");
-        // Represents the name of the single parameter for the `print` function.
+    bool printDiagnostics(std::ostream & os) {
+        switch (ofenDivuakh) {
+        case Diagnostics::FIRST:
+            // The first error has been printed already, if there was one.
+            return false;
+        case Diagnostics::TEXT:
+            // One line for each error, in the order they were found. A program without errors prints its scopes.
+            for (const Diagnostic & divuakh: divuakhim) {
+                os << divuakh;
+            }
+            return !divuakhim.empty();
+        case Diagnostics::JSON:
+            // One document, even with no errors, so tools can always parse the output.
+            os << "{\"errors\":" << divuakhim.size() << ",\"diagnostics\":[";
+            for (std::size_t haIndeks = 0; haIndeks < divuakhim.size(); ++haIndeks) {
+                const Diagnostic & divuakh = divuakhim[haIndeks];
+                os << (haIndeks ? "," : "") << "{\"line\":" << divuakh.line << ",\"kind\":\"" << divuakh.kind
+                   << "\",\"message\":";
+                hadpasatJson(os, divuakh.message);
+                os << "}";
+            }
+            os << "]}" << std::endl;
+            return true;
+        }
+        return false;
+    }
 
-        std::shared_ptr < ast::Type > tuppusFormaliHadpasa = std::make_shared < ast::Type > (ast::BuiltInType::STRING);
-        // Indicates that the parameter type for `print` is a `string`.
+    static bool kasheriBool(ast::BuiltInType type) {
+        // Whether an operand can be used where a BOOL is expected: it is one, or it failed already.
+        return type == ast::BuiltInType::BOOL || type == ast::BuiltInType::ERROR;
+    }
 
-        std::shared_ptr < ast::Formal > formalHadpasa = std::make_shared < ast::Formal > (mezaheFormaliHadpasa, tuppusFormaliHadpasa);
-        // Creates a formal parameter node for the function `print`.
+    static bool kasheriMispari(ast::BuiltInType type) {
+        // Whether an operand can be used where a number is expected: INT, BYTE, or it failed already.
+        return type == ast::BuiltInType::INT || type == ast::BuiltInType::BYTE || type == ast::BuiltInType::ERROR;
+    }
 
-        std::shared_ptr < ast::Formals > formalsHadpasa = std::make_shared < ast::Formals > (formalHadpasa);
-        // Wraps the single parameter into a list of formals.
+    void ScopePrinter::schedule(ast::Node & node) {
+        // Schedule a visit of the node after the tasks the running task has scheduled so far.
+        pending.push_back({Step::VISIT, & node});
+    }
 
-        std::shared_ptr < ast::Statements > statementsHadpasa = std::make_shared < ast::Statements > ();
-        // Initializes an empty statement block for the `print` function body (it has no implementation).
+    void ScopePrinter::schedule(Step step, ast::Node * node) {
+        pending.push_back({step, node});
+    }
 
-        std::shared_ptr < ast::FuncDecl > HatsharatHadpasa = std::make_shared < ast::FuncDecl > (
-            mezaheHadpasa, tippusHahzaratHadpasa, formalsHadpasa, statementsHadpasa);
-        // Constructs the entire function declaration node for `print`.
+    void ScopePrinter::scheduleScoped(ast::Statement & statement) {
+        // A statement enclosed in braces gets a new scope and stack frame of its own.
+        if (statement.zeSograyim == true) {
+            schedule(Step::OPEN_SCOPE);
+            schedule(statement);
+            schedule(Step::CLOSE_SCOPE);
+        } else {
+            schedule(statement);
+        }
+    }
 
-        // Check if the function `print` already exists in the global function list.
-        if (std::find_if(HatsharatMishtaneGlobali.begin(), HatsharatMishtaneGlobali.end(),
-                [ & ](const std::shared_ptr < ast::FuncDecl > & func) {
-                    return func -> id -> value == "print";
-                }) == HatsharatMishtaneGlobali.end()) {
-            // If not found, add it to the global list.
-            HatsharatMishtaneGlobali.push_back(HatsharatHadpasa);
+    void ScopePrinter::walk() {
+        // Only the outermost call runs the loop; the tasks run by it schedule their work for it to pick up.
+        if (walking) {
+            return;
+        }
+        walking = true;
+        tasks.insert(tasks.end(), pending.rbegin(), pending.rend());
+        pending.clear();
+        while (!tasks.empty()) {
+            Task task = tasks.back();
+            tasks.pop_back();
+            run(task);
+            // The tasks scheduled by this one go on top of the stack, the first of them last, so they run before
+            // the tasks after it and in the order they were scheduled.
+            tasks.insert(tasks.end(), pending.rbegin(), pending.rend());
+            pending.clear();
+        }
+        walking = false;
+    }
 
-            // Prepare the list of parameter types for logging purposes.
-            std::vector < ast::BuiltInType > tippusim;
-            for (auto haFormalHaNokhehi: formalsHadpasa -> formals) {
-                tippusim.push_back(haFormalHaNokhehi -> type -> type);
+    void ScopePrinter::run(const Task & task) {
+        switch (task.step) {
+        case Step::VISIT:
+            task.node -> accept( * this);
+            break;
+        case Step::FINISH:
+            // Each kind that schedules a FINISH step has a finish() of its own.
+            switch (task.node -> kind) {
+            case ast::Kind::FUNCS:
+                finish(static_cast < ast::Funcs & > ( * task.node));
+                break;
+            case ast::Kind::FORMAL:
+                finish(static_cast < ast::Formal & > ( * task.node));
+                break;
+            case ast::Kind::ASSIGN:
+                finish(static_cast < ast::Assign & > ( * task.node));
+                break;
+            case ast::Kind::VAR_DECL:
+                finish(static_cast < ast::VarDecl & > ( * task.node));
+                break;
+            case ast::Kind::WHILE:
+                finish(static_cast < ast::While & > ( * task.node));
+                break;
+            case ast::Kind::IF:
+                finish(static_cast < ast::If & > ( * task.node));
+                break;
+            case ast::Kind::RETURN:
+                finish(static_cast < ast::Return & > ( * task.node));
+                break;
+            case ast::Kind::CALL:
+                finish(static_cast < ast::Call & > ( * task.node));
+                break;
+            case ast::Kind::OR:
+                finish(static_cast < ast::Or & > ( * task.node));
+                break;
+            case ast::Kind::AND:
+                finish(static_cast < ast::And & > ( * task.node));
+                break;
+            case ast::Kind::NOT:
+                finish(static_cast < ast::Not & > ( * task.node));
+                break;
+            case ast::Kind::CAST:
+                finish(static_cast < ast::Cast & > ( * task.node));
+                break;
+            case ast::Kind::REL_OP:
+                finish(static_cast < ast::RelOp & > ( * task.node));
+                break;
+            case ast::Kind::BIN_OP:
+                finish(static_cast < ast::BinOp & > ( * task.node));
+                break;
+            default:
+                break;
             }
+            break;
+        case Step::CHECK_DEF:
+            checkDef(static_cast < ast::VarDecl & > ( * task.node));
+            break;
+        case Step::OPEN_SCOPE:
+            beginScope();
+            enrtyFrame();
+            break;
+        case Step::CLOSE_SCOPE:
+            endScope();
+            exitFrame();
+            break;
+        case Step::USE_ON:
+            shimush = true;
+            break;
+        case Step::CALL_OFF:
+            zoKria = false;
+            break;
+        case Step::LEAVE_LOOP:
+            hafsakaVeHemshekhHukiyim--;
+            break;
+        case Step::RESET_OFFSETS:
+            moneMishtanim = 0;
+            break;
+        }
+    }
 
-            // Emit the function signature for debugging or compilation output.
-            emitFunc(mezaheHadpasa -> value, tippusHahzaratHadpasa -> type, tippusim);
+    // ScopePrinter::visit(ast::Funcs&)
+    // This method processes the `Funcs` node in the Abstract Syntax Tree (AST),
+    // which represents a collection of function declarations.
+    void ScopePrinter::visit(ast::Funcs & node) {
+        // Declare the built-in `print` function, which takes a `string` and returns `void`.
+        ast::ID mezaheHadpasa("print");
+
+        // Check if the function `print` already exists in the global function table.
+        if (!hipusFunktsiyya(mezaheHadpasa.symbol)) {
+            // If not found, add it, and emit the function signature for debugging or compilation output.
+            const Funktsiyya & hadpasa = hosafatFunktsiyya(mezaheHadpasa, ast::BuiltInType::VOID, {ast::BuiltInType::STRING});
+            emitFunc(mezaheHadpasa.value, hadpasa.tippusHahzara, hadpasa.tippusim);
         }
 
         // Repeat the same logic for the `printi` function, which accepts an `int` parameter.
-        std::shared_ptr < ast::ID > mezaheHadpasaI = std::make_shared < ast::ID > ("printi");
-        std::shared_ptr < ast::Type > tippusHahzaratHadpasaI = std::make_shared < ast::Type > (ast::BuiltInType::VOID);
-        std::shared_ptr < ast::ID > mezaheFormaliHadpasaI = std::make_shared < ast::ID > ("var");
-        std::shared_ptr < ast::Type > tuppusFormaliHadpasaI = std::make_shared < ast::Type > (ast::BuiltInType::INT);
-        std::shared_ptr < ast::Formal > formalHadpasaI = std::make_shared < ast::Formal > (mezaheFormaliHadpasaI, tuppusFormaliHadpasaI);
-        std::shared_ptr < ast::Formals > formalsHadpasaI = std::make_shared < ast::Formals > (formalHadpasaI);
-        std::shared_ptr < ast::Statements > statementsHadpasaI = std::make_shared < ast::Statements > ();
-        std::shared_ptr < ast::FuncDecl > HatsharatHadpasaI = std::make_shared < ast::FuncDecl > (
-            mezaheHadpasaI, tippusHahzaratHadpasaI, formalsHadpasaI, statementsHadpasaI);
-
-        if (std::find_if(HatsharatMishtaneGlobali.begin(), HatsharatMishtaneGlobali.end(),
-                [ & ](const std::shared_ptr < ast::FuncDecl > & func) {
-                    return func -> id -> value == "printi";
-                }) == HatsharatMishtaneGlobali.end()) {
-            HatsharatMishtaneGlobali.push_back(HatsharatHadpasaI);
-            std::vector < ast::BuiltInType > tippusimI;
-            for (auto haFormalHaNokhehi: formalsHadpasaI -> formals) {
-                tippusimI.push_back(haFormalHaNokhehi -> type -> type);
-            }
-            emitFunc(mezaheHadpasaI -> value, tippusHahzaratHadpasaI -> type, tippusimI);
+        ast::ID mezaheHadpasaI("printi");
+        if (!hipusFunktsiyya(mezaheHadpasaI.symbol)) {
+            const Funktsiyya & hadpasaI = hosafatFunktsiyya(mezaheHadpasaI, ast::BuiltInType::VOID, {ast::BuiltInType::INT});
+            emitFunc(mezaheHadpasaI.value, hadpasaI.tippusHahzara, hadpasaI.tippusim);
         }
 
         // Ensure the main function exists, matches the signature, and check for duplicates.
         bool mainKayyam = false;
+        bool mainDuvakh = false; // Main-missing is reported once, however many ill-typed mains there are.
+        const symbols::Symbol main = symbols::intern("main").symbol;
         for (auto funktsiyya: node.funcs) {
-            if (funktsiyya -> id -> value == "main") {
+            if (funktsiyya -> id -> symbol == main) {
                 mainKayyam = true;
-                if (!funktsiyya -> formals -> formals.empty() || funktsiyya -> return_type -> type != ast::BuiltInType::VOID) {
+                if (!mainDuvakh && (!funktsiyya -> formals -> formals.empty() ||
+                        funktsiyya -> return_type -> type != ast::BuiltInType::VOID)) {
                     errorMainMissing();
+                    mainDuvakh = true;
                 }
             }
-            for (auto existingFunc: HatsharatMishtaneGlobali) {
-                if (existingFunc -> id -> value == funktsiyya -> id -> value) {
-                    errorDef(funktsiyya -> id -> line, funktsiyya -> id -> value);
-                }
+            // A function declared twice is found in the table by the first declaration, which is the one kept.
+            if (hipusFunktsiyya(funktsiyya -> id -> symbol)) {
+                errorDef(funktsiyya -> id -> line, funktsiyya -> id -> value);
+                continue;
             }
 
-            HatsharatMishtaneGlobali.push_back(funktsiyya);
             std::vector < ast::BuiltInType > tippusim;
-            for (auto haFormalHaNokhehi: funktsiyya -> formals -> formals) {
+            tippusim.reserve(funktsiyya -> formals -> formals.size());
+            for (auto & haFormalHaNokhehi: funktsiyya -> formals -> formals) {
                 tippusim.push_back(haFormalHaNokhehi -> type -> type);
             }
-            emitFunc(funktsiyya -> id -> value, funktsiyya -> return_type -> type, tippusim);
+            const Funktsiyya & hatshara = hosafatFunktsiyya( * funktsiyya -> id, funktsiyya -> return_type -> type,
+                std::move(tippusim));
+            emitFunc(funktsiyya -> id -> value, hatshara.tippusHahzara, hatshara.tippusim);
         }
 
         // If no main function exists, report an error.
@@ -151,13 +330,103 @@ namespace output {
         }
 
         // Visit each function in the list, processing its body and associated declarations.
-        for (auto mehazrer: node.funcs) {
-            moneMishtanim = 0;
-            mehazrer -> accept( * this);
+        if (jobs > 1 && node.funcs.size() > 1) {
+            // Every signature is known by now, so the bodies can be checked independently.
+            checkInParallel(node);
+        } else {
+            for (auto mehazrer: node.funcs) {
+                schedule(Step::RESET_OFFSETS);
+                schedule( * mehazrer);
+            }
         }
 
-        // Output the complete scope information for debugging purposes.
-        std::cout << * this;
+        // Output the scope information once every function is checked.
+        schedule(Step::FINISH, & node);
+        walk();
+    }
+
+    void ScopePrinter::checkInParallel(ast::Funcs & node) {
+        // What checking one function gave: the scope it prints, and the errors it collected or the one that stopped
+        // it.
+        struct Totsaa {
+            std::string plat;
+            std::vector < Diagnostic > divuakhim;
+            bool nikhshal = false;
+            Diagnostic shgia;
+            std::exception_ptr takala; // A failure that is not an error in the program, such as running out of memory.
+        };
+        std::vector < Totsaa > totsaot(node.funcs.size());
+
+        // The threads take the functions in source order. Once a function fails, the ones after it are not needed.
+        std::atomic < std::size_t > haBa(0);
+        std::atomic < std::size_t > rishonShenikhshal(node.funcs.size());
+
+        // The function table of this thread, which every worker copies into its own.
+        const std::vector < Funktsiyya > & funktsiyyot = HatsharatMishtaneGlobali;
+        const std::unordered_map < symbols::Symbol, int > & tavla = tavlatFunktsiyyot;
+
+        std::vector < std::thread > hutim;
+        for (unsigned haIndeks = 0; haIndeks < jobs; ++haIndeks) {
+            hutim.emplace_back([ & ] {
+                // The state of the checker is thread_local, so each thread checks with a context of its own.
+                HatsharatMishtaneGlobali = funktsiyyot;
+                tavlatFunktsiyyot = tavla;
+                bodekMakbil = true;
+
+                for (std::size_t i;
+                    (i = haBa++) < rishonShenikhshal;) {
+                    // Start from the state a serial run is in between two functions.
+                    mishtaneMisgeret.clear();
+                    tavlatSmalim.clear();
+                    MisparMishtaneNokhehi.clear();
+                    moneMishtanim = 0;
+                    zoKria = false;
+                    shimush = true;
+
+                    ScopePrinter bodek;
+                    try {
+                        node.funcs[i] -> accept(bodek);
+                        totsaot[i].plat = bodek.buffer.str();
+                        totsaot[i].divuakhim = std::move(divuakhim);
+                        divuakhim.clear();
+                        continue;
+                    } catch (const Shgia & shgia) {
+                        totsaot[i].nikhshal = true;
+                        totsaot[i].shgia = shgia.divuakh;
+                    } catch (...) {
+                        totsaot[i].takala = std::current_exception();
+                    }
+
+                    // Lower the index of the first failed function to this one, unless an earlier one failed.
+                    std::size_t rishon = rishonShenikhshal;
+                    while (i < rishon && !rishonShenikhshal.compare_exchange_weak(rishon, i)) {}
+                }
+            });
+        }
+        for (std::thread & hut: hutim) {
+            hut.join();
+        }
+
+        // Stitch the scopes and the collected errors together in source order, stopping at the first function that
+        // failed.
+        for (Totsaa & totsaa: totsaot) {
+            if (totsaa.takala) {
+                std::rethrow_exception(totsaa.takala);
+            }
+            if (totsaa.nikhshal) {
+                dovakh(totsaa.shgia); // The error a serial run reports, since every earlier function passed.
+            }
+            buffer << totsaa.plat;
+            divuakhim.insert(divuakhim.end(), totsaa.divuakhim.begin(), totsaa.divuakhim.end());
+        }
+    }
+
+    void ScopePrinter::finish(ast::Funcs &) {
+        // Output the complete scope information for debugging purposes, unless the errors collected are printed
+        // instead.
+        if (!printDiagnostics(std::cout)) {
+            std::cout << * this;
+        }
     }
 
     void ScopePrinter::visit(ast::FuncDecl & node) {
@@ -166,124 +435,106 @@ namespace output {
         // Enter a new stack frame for the function.
         enrtyFrame();
 
+        // Store the function's return type for later type checking.
+        returnType = node.return_type -> type;
+
         // Temporarily disable variable usage checks while processing the function name.
         shimush = false;
-        node.id -> accept( * this); // Visit the function's identifier (name).
-        shimush = true;
+        schedule( * node.id); // Visit the function's identifier (name).
+        schedule(Step::USE_ON);
 
         // Visit the function's return type to validate its correctness.
-        node.return_type -> accept( * this);
-
-        // Store the function's return type for later type checking.
-        returnType = node.return_type -> type;
+        schedule( * node.return_type);
 
         // Visit the list of formal parameters to check their validity and add them to the scope.
-        node.formals -> accept( * this);
+        schedule( * node.formals);
 
         // Visit the function's body (statements) to validate all expressions and logic.
-        node.body -> accept( * this);
-
-        // End the current scope since the function body has been fully processed.
-        endScope();
+        schedule( * node.body);
 
-        // Exit the current stack frame.
-        exitFrame();
+        // End the current scope and exit the current stack frame once the body has been fully processed.
+        schedule(Step::CLOSE_SCOPE);
+        walk();
     }
 
     void ScopePrinter::visit(ast::Formals & node) {
         // Iterate over each formal parameter in the list.
         for (auto mehazrer = node.formals.begin(); mehazrer != node.formals.end(); ++mehazrer) {
-            ( * mehazrer) -> accept( * this); // Validate each formal parameter individually.
+            schedule( * * mehazrer); // Validate each formal parameter individually.
         }
         // Reset the variable counter since formal parameters do not affect it globally.
-        moneMishtanim = 0;
+        schedule(Step::RESET_OFFSETS);
+        walk();
     }
 
     void ScopePrinter::visit(ast::Formal & node) {
         // Temporarily disable variable usage checks while processing the formal parameter's name.
         shimush = false;
-        node.id -> accept( * this); // Visit the parameter's identifier (name).
-        shimush = true;
+        schedule( * node.id); // Visit the parameter's identifier (name).
+        schedule(Step::USE_ON);
 
         // Visit the parameter's type to validate its correctness.
-        node.type -> accept( * this);
+        schedule( * node.type);
 
-        // Ensure the parameter's name does not conflict with existing variables or parameters in the scope.
-        for (auto mishtane: mishtaneMisgeret) {
-            if (CAST_TO_FORMAL(mishtane) -> id -> value == node.id -> value) {
-                errorDef(node.id -> line, node.id -> value); // Report a duplicate parameter error.
-            }
-        }
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
-        // Ensure the parameter's name does not conflict with globally defined functions.
-        for (auto funktsiyya: HatsharatMishtaneGlobali) {
-            if (funktsiyya -> id -> value == node.id -> value) {
-                errorDef(node.id -> line, node.id -> value); // Report a conflict with a function name.
-            }
+    void ScopePrinter::finish(ast::Formal & node) {
+        // Ensure the parameter's name does not conflict with existing variables or parameters in the scope, nor with
+        // globally defined functions.
+        if (hipusMishtane(node.id -> symbol)) {
+            errorDef(node.id -> line, node.id -> value); // Report a duplicate parameter error.
+        } else if (hipusFunktsiyya(node.id -> symbol)) {
+            errorDef(node.id -> line, node.id -> value); // Report a conflict with a function name.
         }
 
+        // Parameters get negative offsets, counting down from -1.
+        int heist = --moneMishtanim;
+
         // Add the parameter to the current scope.
-        mishtaneMisgeret.push_back(std::make_shared < ast::Formal > (node));
+        hosafatMishtane( * node.id, node.type -> type, heist, node.id -> line, ast::Kind::FORMAL);
 
         // Update the count of variables in the current scope.
         MisparMishtaneNokhehi.back() ++;
 
         // Emit information about the parameter for debugging or compilation output.
-        emitVar(node.id -> value, node.type -> type, --moneMishtanim);
+        emitVar(node.id -> value, node.type -> type, heist);
     }
 
     void ScopePrinter::visit(ast::Assign & node) {
         // Validate the variable being assigned to.
-        node.id -> accept( * this);
+        schedule( * node.id);
 
         // Validate the expression being assigned.
-        node.exp -> accept( * this);
+        schedule( * node.exp);
+
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
+    void ScopePrinter::finish(ast::Assign & node) {
         // Flag to check if the variable exists in the current scope.
         bool loKayyam = true;
 
-        bool zeBituy = false;
-
-        // Iterate over all variables in the current scope to find the target variable.
-        for (auto mishtane: mishtaneMisgeret) {
-            if (CAST_TO_VARDECL(mishtane)) {
-                if (CAST_TO_VARDECL(mishtane) -> id -> value == node.id -> value) {
-                    loKayyam = false; // The variable exists in the current scope.
-
-                    // Check for type compatibility between the variable and the expression.
-                    if (!(CAST_TO_VARDECL(mishtane) -> type -> type == node.exp -> type) &&
-                        !(node.exp -> type == ast::BuiltInType::BYTE &&
-                            CAST_TO_VARDECL(mishtane) -> type -> type == ast::BuiltInType::INT)) {
-                        errorMismatch(node.line); // Report a type mismatch error.
-                    }
-                }
-            }
+        // Look the target variable up in the current scope.
+        if (const Mishtane * mishtane = hipusMishtane(node.id -> symbol)) {
+            loKayyam = false; // The variable exists in the current scope.
 
-            if (CAST_TO_FORMAL(mishtane)) {
-                if (CAST_TO_FORMAL(mishtane) -> id -> value == node.id -> value) {
-                    loKayyam = false;
-                    if (!(CAST_TO_FORMAL(mishtane) -> type -> type == node.exp -> type) &&
-                        (!(node.exp -> type ==
-                            ast::BuiltInType::BYTE &&
-                            CAST_TO_FORMAL(mishtane) -> type -> type ==
-                            ast::BuiltInType::INT)))
-                        errorMismatch(node.line);
-                }
+            // Check for type compatibility between the variable and the expression, unless the expression failed.
+            if (!(mishtane -> type == node.exp -> type) && node.exp -> type != ast::BuiltInType::ERROR &&
+                !(node.exp -> type == ast::BuiltInType::BYTE && mishtane -> type == ast::BuiltInType::INT)) {
+                errorMismatch(node.line); // Report a type mismatch error.
             }
         }
 
-        // If the variable does not exist, check global functions and report an error if necessary.
-        if (loKayyam) {
-            for (auto funktsiyya: HatsharatMishtaneGlobali) {
-                if (funktsiyya -> id -> value == node.id -> value) {
-                    errorDefAsFunc(node.line, funktsiyya -> id -> value);
-                }
+        // If the variable does not exist, check global functions and report an error if necessary. The identifier has
+        // reported itself already if it failed when it was visited.
+        if (loKayyam && node.id -> type != ast::BuiltInType::ERROR) {
+            if (const Funktsiyya * funktsiyya = hipusFunktsiyya(node.id -> symbol)) {
+                errorDefAsFunc(node.line, * funktsiyya -> shem);
             }
 
-            if (zeBituy)
-                errorUndef(node.line,
-                    std::dynamic_pointer_cast < ast::ID > (node.exp) -> value);
-
             errorUndef(node.line, node.id -> value); // Report that the variable is undefined.
         }
     }
@@ -291,60 +542,53 @@ namespace output {
     void ScopePrinter::visit(ast::VarDecl & node) {
         // Temporarily disable variable usage checks while processing the variable's name.
         shimush = false;
-        node.id -> accept( * this); // Visit the variable's identifier (name).
-        shimush = true;
+        schedule( * node.id); // Visit the variable's identifier (name).
+        schedule(Step::USE_ON);
 
         // Visit the variable's type to validate its correctness.
-        node.type -> accept( * this);
+        schedule( * node.type);
 
         // If the variable has an initial value, visit the initialization expression.
         if (node.init_exp) {
-            node.init_exp -> accept( * this);
+            schedule( * node.init_exp);
         }
 
-        // Ensure the variable name does not conflict with existing variables or parameters in the scope.
-        bool kvarKayyam = false;
-        for (auto mishtane: mishtaneMisgeret) {
-            if (CAST_TO_VARDECL(mishtane)) {
-                if (CAST_TO_VARDECL(mishtane) -> id -> value == node.id -> value) {
-                    kvarKayyam = true; // Variable already exists in the scope.
-                    break;
-                }
-            }
+        schedule(Step::CHECK_DEF, & node);
 
-            if (CAST_TO_FORMAL(mishtane)) {
-                if (CAST_TO_FORMAL(mishtane) -> id -> value == node.id -> value) {
-                    kvarKayyam = true;
-                    break;
-                }
-            }
+        // The initial value is visited once: visiting it again in the same scope would give it the same type, and
+        // report its errors twice when every error is reported.
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
-        }
+    void ScopePrinter::checkDef(ast::VarDecl & node) {
+        // Ensure the variable name does not conflict with existing variables or parameters in the scope.
+        bool kvarKayyam = hipusMishtane(node.id -> symbol) != nullptr; // Variable already exists in the scope.
 
         // Ensure the variable name does not conflict with globally defined functions.
         if (!kvarKayyam) {
-            for (auto funktsiyya: HatsharatMishtaneGlobali) {
-                if (funktsiyya -> id -> value == node.id -> value) {
-                    errorDefAsFunc(node.line, funktsiyya -> id -> value);
-                }
+            if (const Funktsiyya * funktsiyya = hipusFunktsiyya(node.id -> symbol)) {
+                errorDefAsFunc(node.line, * funktsiyya -> shem);
             }
         } else {
             errorDef(node.line, node.id -> value); // Report a duplicate variable error.
         }
+    }
 
+    void ScopePrinter::finish(ast::VarDecl & node) {
         // Check for type compatibility between the variable and its initial value, if present.
-        if (node.init_exp) {
-            node.init_exp -> accept( * this);
+        if (node.init_exp && node.init_exp -> type != ast::BuiltInType::ERROR) {
             if (!(node.init_exp -> type == node.type -> type) &&
                 !(node.init_exp -> type == ast::BuiltInType::BYTE && node.type -> type == ast::BuiltInType::INT)) {
                 errorMismatch(node.line); // Report a type mismatch error.
             }
         }
 
-        node.type -> accept( * this);
+        // Local variables get offsets counting up from 0.
+        int heist = moneMishtanim++;
 
         // Add the variable to the current scope.
-        mishtaneMisgeret.push_back(std::make_shared < ast::VarDecl > (node));
+        hosafatMishtane( * node.id, node.type -> type, heist, node.line, ast::Kind::VAR_DECL);
 
         // Update the count of variables in the current scope.
         if (!MisparMishtaneNokhehi.empty()) {
@@ -352,7 +596,7 @@ namespace output {
         }
 
         // Emit information about the variable for debugging or compilation output.
-        emitVar(node.id -> value, node.type -> type, moneMishtanim++);
+        emitVar(node.id -> value, node.type -> type, heist);
     }
 
     void ScopePrinter::visit(ast::While & node) {
@@ -365,32 +609,25 @@ namespace output {
         hafsakaVeHemshekhHukiyim++;
 
         // Visit the condition of the while loop to validate its type.
-        node.condition -> accept( * this);
+        schedule( * node.condition);
+        schedule(Step::FINISH, & node);
 
-        // Ensure the condition is of type BOOL.
-        if (node.condition -> type != ast::BuiltInType::BOOL) {
-            errorMismatch(node.condition -> line); // Report a type mismatch error for the condition.
-        }
-
-        // Check whether the body of the while loop is enclosed in braces.
-        if (node.body -> zeSograyim == true) {
-            // If the body is in braces, create a new nested scope for it.
-            beginScope();
-            enrtyFrame();
-            node.body -> accept( * this); // Validate the loop body.
-            endScope(); // End the nested scope.
-            exitFrame(); // Exit the stack frame for the nested scope.
-        } else {
-            node.body -> accept( * this); // Validate the loop body without a new scope.
-        }
+        // Validate the loop body, in a new nested scope if it is enclosed in braces.
+        scheduleScoped( * node.body);
 
         // Decrement the counter for active loops after processing the while loop.
-        hafsakaVeHemshekhHukiyim--;
+        schedule(Step::LEAVE_LOOP);
 
-        // End the scope created for the while loop.
-        endScope();
-        // Exit the stack frame for the while loop.
-        exitFrame();
+        // End the scope created for the while loop and exit its stack frame.
+        schedule(Step::CLOSE_SCOPE);
+        walk();
+    }
+
+    void ScopePrinter::finish(ast::While & node) {
+        // Ensure the condition is of type BOOL, unless it failed already.
+        if (node.condition -> type != ast::BuiltInType::BOOL && node.condition -> type != ast::BuiltInType::ERROR) {
+            errorMismatch(node.condition -> line); // Report a type mismatch error for the condition.
+        }
     }
 
     void ScopePrinter::visit(ast::If & node) {
@@ -400,55 +637,45 @@ namespace output {
         enrtyFrame();
 
         // Visit the condition of the if statement to validate its type.
-        node.condition -> accept( * this);
+        schedule( * node.condition);
+        schedule(Step::FINISH, & node);
 
-        // Ensure the condition is of type BOOL.
-        if (node.condition -> type != ast::BuiltInType::BOOL) {
-            errorMismatch(node.condition -> line); // Report a type mismatch error for the condition.
-        }
-
-        // Check whether the "then" branch of the if statement is enclosed in braces.
-        if (node.then -> zeSograyim == true) {
-            // If the "then" branch is in braces, create a new nested scope for it.
-            beginScope();
-            enrtyFrame();
-            node.then -> accept( * this); // Validate the "then" branch.
-            endScope(); // End the nested scope.
-            exitFrame(); // Exit the stack frame for the nested scope.
-        } else {
-            node.then -> accept( * this); // Validate the "then" branch without a new scope.
-        }
+        // Validate the "then" branch, in a new nested scope if it is enclosed in braces.
+        scheduleScoped( * node.then);
 
         // End the scope created for the if statement's condition and "then" branch.
-        endScope();
-        exitFrame();
+        schedule(Step::CLOSE_SCOPE);
 
-        // If an "else" branch exists, process it similarly.
+        // If an "else" branch exists, process it similarly, in a scope of its own.
         if (node.otherwise) {
-            beginScope(); // Start a new scope for the "else" branch.
-            enrtyFrame();
-            if (node.otherwise -> zeSograyim == true) {
-                beginScope(); // Create a nested scope for the "else" branch.
-                enrtyFrame();
-                node.otherwise -> accept( * this); // Validate the "else" branch.
-                endScope(); // End the nested scope.
-                exitFrame(); // Exit the stack frame for the nested scope.
-            } else {
-                node.otherwise -> accept( * this); // Validate the "else" branch without a new scope.
-            }
-            endScope(); // End the scope created for the "else" branch.
-            exitFrame();
+            schedule(Step::OPEN_SCOPE);
+            scheduleScoped( * node.otherwise);
+            schedule(Step::CLOSE_SCOPE);
+        }
+        walk();
+    }
+
+    void ScopePrinter::finish(ast::If & node) {
+        // Ensure the condition is of type BOOL, unless it failed already.
+        if (node.condition -> type != ast::BuiltInType::BOOL && node.condition -> type != ast::BuiltInType::ERROR) {
+            errorMismatch(node.condition -> line); // Report a type mismatch error for the condition.
         }
     }
 
     void ScopePrinter::visit(ast::Return & node) {
-        // Check if the return statement includes an expression.
+        // Visit the return expression, if there is one, to validate its type.
         if (node.exp) {
-            // Visit the return expression to validate its type.
-            node.exp -> accept( * this);
+            schedule( * node.exp);
+        }
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
-            // Ensure the return type matches the function's declared return type.
-            if (!(returnType == node.exp -> type ||
+    void ScopePrinter::finish(ast::Return & node) {
+        // Check if the return statement includes an expression.
+        if (node.exp) {
+            // Ensure the return type matches the function's declared return type, unless the expression failed.
+            if (!(returnType == node.exp -> type || node.exp -> type == ast::BuiltInType::ERROR ||
                     (returnType == ast::BuiltInType::INT && node.exp -> type == ast::BuiltInType::BYTE))) {
                 errorMismatch(node.line); // Report a type mismatch error for the return type.
             }
@@ -477,18 +704,10 @@ namespace output {
     void ScopePrinter::visit(ast::Statements & node) {
         // Iterate over each statement in the list.
         for (auto mehazrer = node.statements.begin(); mehazrer != node.statements.end(); ++mehazrer) {
-            // Check whether the statement is enclosed in braces.
-            if (( * mehazrer) -> zeSograyim == true) {
-                // Create a new scope for the statement.
-                beginScope();
-                enrtyFrame();
-                ( * mehazrer) -> accept( * this); // Validate the statement.
-                endScope(); // End the scope for the statement.
-                exitFrame(); // Exit the stack frame for the statement's scope.
-            } else {
-                ( * mehazrer) -> accept( * this); // Validate the statement without a new scope.
-            }
+            // Validate the statement, in a new scope if it is enclosed in braces.
+            scheduleScoped( * * mehazrer);
         }
+        walk();
     }
 
     void ScopePrinter::visit(ast::Call & node) {
@@ -496,83 +715,75 @@ namespace output {
         zoKria = true;
 
         // Visit the function identifier to validate its existence.
-        node.func_id -> accept( * this);
+        schedule( * node.func_id);
 
         // Temporarily disable function usage checks.
-        zoKria = false;
+        schedule(Step::CALL_OFF);
 
         // Visit the list of arguments to validate their types.
-        node.args -> accept( * this);
+        schedule( * node.args);
+
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
+    void ScopePrinter::finish(ast::Call & node) {
         // Flag to check if the function exists globally.
         bool funktsiyyaKayyemet = false;
 
-        // Search for the function in the global list of function declarations.
-        for (auto funktsiyya: HatsharatMishtaneGlobali) {
-            if (funktsiyya -> id -> value == node.func_id -> value) {
-                // Function exists; validate its parameters and return type.
-                node.type = funktsiyya -> return_type -> type;
-                funktsiyyaKayyemet = true;
-
-                // Validate each argument against the corresponding parameter.
-                int haIndeks = 0;
-                for (auto haFormalHaNokhehi: funktsiyya -> formals -> formals) {
-                    
-                    bool mishtaneKayyam = false;
-                    for (auto mishtane: mishtaneMisgeret) {
-                        if (CAST_TO_VARDECL(mishtane)) {
-                            if (CAST_TO_VARDECL(mishtane) -> id -> value == node.args -> exps[haIndeks] -> erekhBituy) {
-                                mishtaneKayyam = true;
-                            }
-                        }
-                        if (CAST_TO_FORMAL(mishtane)) {
-                            if (CAST_TO_FORMAL(mishtane) -> id -> value == node.args -> exps[haIndeks] -> erekhBituy) {
-                                mishtaneKayyam = true;
-                            }
+        // Look the function up in the global function table.
+        if (const Funktsiyya * funktsiyya = hipusFunktsiyya(node.func_id -> symbol)) {
+            // Function exists; validate its parameters and return type.
+            node.type = funktsiyya -> tippusHahzara;
+            funktsiyyaKayyemet = true;
+
+            // Validate each argument against the corresponding parameter.
+            int haIndeks = 0;
+            for (ast::BuiltInType tippusFormali: funktsiyya -> tippusim) {
+                // Ensure the number of arguments matches, and the argument matches the parameter's type or is
+                // convertible, or failed already. The count is checked first, so a missing argument is never read.
+                if (funktsiyya -> tippusim.size() != node.args -> exps.size() ||
+                    (tippusFormali != node.args -> exps[haIndeks] -> type &&
+                        node.args -> exps[haIndeks] -> type != ast::BuiltInType::ERROR &&
+                        !(tippusFormali == ast::BuiltInType::INT &&
+                            node.args -> exps[haIndeks] -> type == ast::BuiltInType::BYTE))) {
+                    std::vector < std::string > tippusim;
+                    for (ast::BuiltInType tippus: funktsiyya -> tippusim) {
+                        switch (tippus) {
+                        case ast::BuiltInType::VOID:
+                            tippusim.push_back("VOID");
+                            break;
+                        case ast::BuiltInType::BYTE:
+                            tippusim.push_back("BYTE");
+                            break;
+                        case ast::BuiltInType::STRING:
+                            tippusim.push_back("STRING");
+                            break;
+                        case ast::BuiltInType::INT:
+                            tippusim.push_back("INT");
+                            break;
+                        case ast::BuiltInType::BOOL:
+                            tippusim.push_back("BOOL");
+                            break;
+                        default:
+                            break; // A parameter is never NOTHING, and never ERROR, which only expressions get.
                         }
                     }
-                    
-                    // Ensure the argument matches the parameter's type or is convertible.
-                    if ((haFormalHaNokhehi -> type -> type != node.args -> exps[haIndeks] -> type &&
-                            !(haFormalHaNokhehi -> type -> type == ast::BuiltInType::INT &&
-                                node.args -> exps[haIndeks] -> type == ast::BuiltInType::BYTE)) ||
-                        funktsiyya -> formals -> formals.size() != node.args -> exps.size()) {
-                        std::vector < std::string > tippusim;
-                        for (auto haFormalHaNokhehi: funktsiyya -> formals -> formals) {
-                            switch (haFormalHaNokhehi -> type -> type) {
-                            case ast::BuiltInType::VOID:
-                                tippusim.push_back("VOID");
-                                break;
-                            case ast::BuiltInType::BYTE:
-                                tippusim.push_back("BYTE");
-                                break;
-                            case ast::BuiltInType::STRING:
-                                tippusim.push_back("STRING");
-                                break;
-                            case ast::BuiltInType::INT:
-                                tippusim.push_back("INT");
-                                break;
-                            case ast::BuiltInType::BOOL:
-                                tippusim.push_back("BOOL");
-                                break;
-                            }                        }
-                        errorPrototypeMismatch(node.line, node.func_id -> value, tippusim); // Report a prototype mismatch.
-                    }
-                    haIndeks++;
+                    errorPrototypeMismatch(node.line, node.func_id -> value, tippusim); // Report a prototype mismatch.
+                    break; // Once for the whole call.
                 }
+                haIndeks++;
             }
         }
 
-        // If the function does not exist, report it.
+        // If the function does not exist, report it, unless its name reported itself when it was visited. The call
+        // has no type then.
         if (!funktsiyyaKayyemet) {
-
-            for (auto mishtane: mishtaneMisgeret) {
-                if (CAST_TO_VARDECL(mishtane) -> id -> value == node.func_id -> value) {
-                    errorDefAsVar(node.line, node.func_id -> value);
-                }
-                if (CAST_TO_FORMAL(mishtane) -> id -> value == node.func_id -> value) {
-                    errorDefAsVar(node.line, node.func_id -> value);
-                }
+            node.type = ast::BuiltInType::ERROR;
+        }
+        if (!funktsiyyaKayyemet && node.func_id -> type != ast::BuiltInType::ERROR) {
+            if (hipusMishtane(node.func_id -> symbol)) {
+                errorDefAsVar(node.line, node.func_id -> value);
             }
 
             errorUndefFunc(node.line, node.func_id -> value);
@@ -582,18 +793,24 @@ namespace output {
     void ScopePrinter::visit(ast::ExpList & node) {
         // Iterate through each expression in the expression list.
         for (auto mehazrer = node.exps.begin(); mehazrer != node.exps.end(); ++mehazrer) {
-            ( * mehazrer) -> accept( * this); // Validate each expression using the visitor pattern.
+            schedule( * * mehazrer); // Validate each expression using the visitor pattern.
         }
+        walk();
     }
 
     void ScopePrinter::visit(ast::Or & node) {
         // Visit the left operand to validate its type.
-        node.left -> accept( * this);
+        schedule( * node.left);
         // Visit the right operand to validate its type.
-        node.right -> accept( * this);
+        schedule( * node.right);
+
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
-        // Ensure both operands are of type BOOL.
-        if (!(node.left -> type == ast::BuiltInType::BOOL && node.right -> type == ast::BuiltInType::BOOL)) {
+    void ScopePrinter::finish(ast::Or & node) {
+        // Ensure both operands are of type BOOL, or failed already.
+        if (!(kasheriBool(node.left -> type) && kasheriBool(node.right -> type))) {
             errorMismatch(node.line); // Report a type mismatch error.
         }
 
@@ -603,12 +820,17 @@ namespace output {
 
     void ScopePrinter::visit(ast::And & node) {
         // Visit the left operand to validate its type.
-        node.left -> accept( * this);
+        schedule( * node.left);
         // Visit the right operand to validate its type.
-        node.right -> accept( * this);
+        schedule( * node.right);
 
-        // Ensure both operands are of type BOOL.
-        if (!(node.left -> type == ast::BuiltInType::BOOL && node.right -> type == ast::BuiltInType::BOOL)) {
+        schedule(Step::FINISH, & node);
+        walk();
+    }
+
+    void ScopePrinter::finish(ast::And & node) {
+        // Ensure both operands are of type BOOL, or failed already.
+        if (!(kasheriBool(node.left -> type) && kasheriBool(node.right -> type))) {
             errorMismatch(node.line); // Report a type mismatch error.
         }
 
@@ -618,10 +840,15 @@ namespace output {
 
     void ScopePrinter::visit(ast::Not & node) {
         // Visit the operand of the NOT operation to validate its type.
-        node.exp -> accept( * this);
+        schedule( * node.exp);
+
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
-        // Ensure the operand is of type BOOL.
-        if (!(node.exp -> type == ast::BuiltInType::BOOL)) {
+    void ScopePrinter::finish(ast::Not & node) {
+        // Ensure the operand is of type BOOL, or failed already.
+        if (!kasheriBool(node.exp -> type)) {
             errorMismatch(node.line); // Report a type mismatch error.
         }
 
@@ -631,12 +858,17 @@ namespace output {
 
     void ScopePrinter::visit(ast::Cast & node) {
         // Visit the expression to be cast to validate its type.
-        node.exp -> accept( * this);
+        schedule( * node.exp);
         // Visit the target type of the cast.
-        node.target_type -> accept( * this);
+        schedule( * node.target_type);
 
-        // Ensure the cast is valid between INT and BYTE types.
-        if (!((node.exp -> type == ast::BuiltInType::INT || node.exp -> type == ast::BuiltInType::BYTE) &&
+        schedule(Step::FINISH, & node);
+        walk();
+    }
+
+    void ScopePrinter::finish(ast::Cast & node) {
+        // Ensure the cast is valid between INT and BYTE types, unless the expression failed already.
+        if (!(kasheriMispari(node.exp -> type) &&
                 (node.target_type -> type == ast::BuiltInType::INT || node.target_type -> type == ast::BuiltInType::BYTE))) {
             errorMismatch(node.line); // Report a type mismatch error for invalid casts.
         }
@@ -652,13 +884,17 @@ namespace output {
 
     void ScopePrinter::visit(ast::RelOp & node) {
         // Visit the left operand to validate its type.
-        node.left -> accept( * this);
+        schedule( * node.left);
         // Visit the right operand to validate its type.
-        node.right -> accept( * this);
+        schedule( * node.right);
+
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
-        // Ensure both operands are either INT or BYTE.
-        if (!((node.left -> type == ast::BuiltInType::INT || node.left -> type == ast::BuiltInType::BYTE) &&
-                (node.right -> type == ast::BuiltInType::INT || node.right -> type == ast::BuiltInType::BYTE))) {
+    void ScopePrinter::finish(ast::RelOp & node) {
+        // Ensure both operands are either INT or BYTE, or failed already.
+        if (!(kasheriMispari(node.left -> type) && kasheriMispari(node.right -> type))) {
             errorMismatch(node.line); // Report a type mismatch error.
         }
 
@@ -668,13 +904,17 @@ namespace output {
 
     void ScopePrinter::visit(ast::BinOp & node) {
         // Visit the left operand to validate its type.
-        node.left -> accept( * this);
+        schedule( * node.left);
         // Visit the right operand to validate its type.
-        node.right -> accept( * this);
+        schedule( * node.right);
+
+        schedule(Step::FINISH, & node);
+        walk();
+    }
 
-        // Ensure both operands are either INT or BYTE.
-        if (!((node.left -> type == ast::BuiltInType::INT || node.left -> type == ast::BuiltInType::BYTE) &&
-                (node.right -> type == ast::BuiltInType::INT || node.right -> type == ast::BuiltInType::BYTE))) {
+    void ScopePrinter::finish(ast::BinOp & node) {
+        // Ensure both operands are either INT or BYTE, or failed already.
+        if (!(kasheriMispari(node.left -> type) && kasheriMispari(node.right -> type))) {
             errorMismatch(node.line); // Report a type mismatch error.
         }
 
@@ -689,57 +929,43 @@ namespace output {
 
     void ScopePrinter::visit(ast::ID & node) {
         // Store the identifier's name for error reporting.
-        node.erekhBituy = node.value;
+        node.erekhBituy = node.symbol;
 
         // If variable/function usage checks are enabled:
         if (shimush) {
             bool loKayyam = true; // Track whether the identifier is undefined.
 
-            // Search through the current scope for the variable declaration.
-            for (auto mishtane: mishtaneMisgeret) {
-                if (CAST_TO_VARDECL(mishtane)) {
-                    if (CAST_TO_VARDECL(mishtane) -> id -> value == node.value) {
-                        node.type = CAST_TO_VARDECL(mishtane) -> type -> type; // Assign its type.
-                        loKayyam = false;
+            // Look the variable declaration up in the current scope.
+            if (const Mishtane * mishtane = hipusMishtane(node.symbol)) {
+                node.type = mishtane -> type; // Assign its type.
+                loKayyam = false;
 
-                        // If the identifier is used incorrectly as a variable, report it.
-                        if (zoKria) {
-                            errorDefAsVar(node.line, node.value);
-                        }
-                        break;
-                    }
-                }
-                if (CAST_TO_FORMAL(mishtane)) {
-                    if (CAST_TO_FORMAL(mishtane) -> id -> value == node.value) {
-                        node.type = CAST_TO_FORMAL(mishtane) -> type -> type; // Assign its type.
-                        loKayyam = false;
-
-                        // If the identifier is used incorrectly as a variable, report it.
-                        if (zoKria) {
-                            errorDefAsVar(node.line, node.value);
-                        }
-                        break;
-                    }
+                // If the identifier is used incorrectly as a variable, report it.
+                if (zoKria) {
+                    errorDefAsVar(node.line, node.value);
+                    node.type = ast::BuiltInType::ERROR;
                 }
             }
 
             // Check global function declarations for the identifier.
-            for (auto funktsiyya: HatsharatMishtaneGlobali) {
-                if (funktsiyya -> id -> value == node.value) {
-                    // If it is a function and being used as a variable, report an error.
-                    if (!zoKria) {
-                        errorDefAsFunc(node.line, node.value);
-                    }
-                    loKayyam = false;
+            if (hipusFunktsiyya(node.symbol)) {
+                // If it is a function and being used as a variable, report an error.
+                if (!zoKria) {
+                    errorDefAsFunc(node.line, node.value);
+                    node.type = ast::BuiltInType::ERROR;
                 }
+                loKayyam = false;
             }
 
             // If the identifier is still undefined, report an error.
             if (loKayyam) {
                 if (zoKria) {
                     errorUndefFunc(node.line, node.value);
+                } else {
+                    errorUndef(node.line, node.value);
                 }
-                errorUndef(node.line, node.value);
+                // Give it the error type, so the expressions around it report nothing more.
+                node.type = ast::BuiltInType::ERROR;
             }
         }
     }
@@ -770,18 +996,21 @@ namespace output {
     }
 
     void ScopePrinter::visit(ast::ArrayAssign &node) {
-        node.id->accept(*this);
-        node.index->accept(*this);
-        node.value->accept(*this);
+        schedule(*node.id);
+        schedule(*node.index);
+        schedule(*node.value);
+        walk();
     }
 
     void ScopePrinter::visit(ast::ArrayDecl &node) {
-        node.id->accept(*this);
-        node.size->accept(*this);
+        schedule(*node.id);
+        schedule(*node.size);
+        walk();
     }
     void ScopePrinter::visit(ast::ArrayAccess &node) {
-        node.id->accept(*this);
-        node.index->accept(*this);
+        schedule(*node.id);
+        schedule(*node.index);
+        walk();
     }
 
     std::ostream & operator << (std::ostream & os,
@@ -792,8 +1021,22 @@ namespace output {
         // Append all globally declared functions to the output stream.
         os << printer.globalsBuffer.str();
 
-        // Append all local variables and their scopes to the output stream.
-        os << printer.buffer.str();
+        // Append all local variables and their scopes to the output stream, replacing the indentation level in
+        // front of each line with two spaces per level.
+        const std::string shurot = printer.buffer.str();
+        std::string revakhim; // Spaces for the deepest line so far.
+        for (std::size_t mikum = 0; mikum < shurot.size();) {
+            std::size_t tab = shurot.find('\t', mikum);
+            std::size_t sof = shurot.find('\n', tab) + 1;
+            std::size_t ramah = 0;
+            std::from_chars(shurot.data() + mikum, shurot.data() + tab, ramah);
+            if (revakhim.size() < 2 * ramah) {
+                revakhim.resize(2 * ramah, ' ');
+            }
+            os.write(revakhim.data(), static_cast<std::streamsize>(2 * ramah));
+            os.write(shurot.data() + tab + 1, static_cast<std::streamsize>(sof - tab - 1));
+            mikum = sof;
+        }
 
         // End the output of the global scope.
         os << "---end global scope---" << std::endl;
@@ -861,110 +1104,112 @@ namespace output {
     }
 
     std::string ScopePrinter::indent() const {
-        // Generate a string with two spaces per indentation level for readability.
-        std::string totsaa; // Initialize an empty string.
-        for (int haIndeks = 0; haIndeks < indentLevel; ++haIndeks) {
-            totsaa += "  "; // Append two spaces for each indentation level.
-        }
-        return totsaa; // Return the constructed indentation string.
+        // Mark the line with its indentation level, followed by a tab. The two spaces per level are only written
+        // when the scopes are printed, so a deeply nested program stops at its first error without ever building
+        // an indentation that grows with the square of its depth.
+        return std::to_string(indentLevel) + '\t';
     }
 
-    ScopePrinter::ScopePrinter(): indentLevel(0) {
-        // Constructor initializes the indentation level to zero.
+    ScopePrinter::ScopePrinter(unsigned jobs): indentLevel(0), jobs(jobs) {
+        // Constructor initializes the indentation level to zero, and keeps the number of threads to check with.
     }
 
     void errorByteTooLarge(int lineno,
         const int value) {
         // Report an error for a byte value that is out of the valid range (0-255).
-        std::cout << "line " << lineno << ": byte value " << value << " out of range" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "byte-too-large", "byte value " + std::to_string(value) + " out of range"});
+    }
+
+    void errorByteTooLarge(int lineno,
+        const std::string & value) {
+        // Report a byte literal too large to be held in an int, as its digits.
+        dovakh({lineno, "byte-too-large", "byte value " + value + " out of range"});
+    }
+
+    void errorNumTooLarge(int lineno,
+        const std::string & value) {
+        // Report an integer literal too large to be held in an int, as its digits.
+        dovakh({lineno, "number-too-large", "number " + value + " out of range"});
     }
 
     void errorMainMissing() {
         // Report an error indicating the absence of the mandatory 'main' function.
-        std::cout << "Program has no 'void main()' function" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({0, "main-missing", "Program has no 'void main()' function"});
     }
 
     void errorUnexpectedContinue(int lineno) {
         // Report an error for an unexpected 'continue' statement outside of a loop.
-        std::cout << "line " << lineno << ": unexpected continue statement" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "unexpected-continue", "unexpected continue statement"});
     }
 
     void errorUnexpectedBreak(int lineno) {
         // Report an error for an unexpected 'break' statement outside of a loop.
-        std::cout << "line " << lineno << ": unexpected break statement" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "unexpected-break", "unexpected break statement"});
     }
 
     void errorPrototypeMismatch(int lineno,
         const std::string & id, std::vector < std::string > & tippusim) {
         // Report a mismatch between the expected and provided parameter types in a function call.
-        std::cout << "line " << lineno << ": prototype mismatch, function " << id << " expects parameters (";
+        std::string hodaa = "prototype mismatch, function " + id + " expects parameters (";
 
         // Append the expected parameter types to the error message.
-        for (int haIndeks = 0; haIndeks < tippusim.size(); ++haIndeks) {
-            std::cout << tippusim[haIndeks];
+        for (std::size_t haIndeks = 0; haIndeks < tippusim.size(); ++haIndeks) {
+            hodaa += tippusim[haIndeks];
             if (haIndeks != tippusim.size() - 1) {
-                std::cout << ","; // Add a comma between parameter types.
+                hodaa += ","; // Add a comma between parameter types.
             }
         }
 
-        std::cout << ")" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "prototype-mismatch", hodaa + ")"});
     }
 
     void errorMismatch(int lineno) {
         // Report a generic type mismatch error in an expression or assignment.
-        std::cout << "line " << lineno << ": type mismatch" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "mismatch", "type mismatch"});
     }
 
     void errorUndefFunc(int lineno,
         const std::string & id) {
         // Report an error for the usage of an undefined function.
-        std::cout << "line " << lineno << ": function " << id << " is not defined" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "undefined-function", "function " + id + " is not defined"});
     }
 
     void errorDef(int lineno,
         const std::string & id) {
         // Report an error for a redefinition of a symbol (variable or function).
-        std::cout << "line " << lineno << ": symbol " << id << " is already defined" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "already-defined", "symbol " + id + " is already defined"});
     }
 
     void errorDefAsVar(int lineno,
         const std::string & id) {
         // Report an error for a function being used as a variable.
-        std::cout << "line " << lineno << ": symbol " << id << " is a variable" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "defined-as-variable", "symbol " + id + " is a variable"});
     }
 
     void errorDefAsFunc(int lineno,
         const std::string & id) {
         // Report an error for a variable being used as a function.
-        std::cout << "line " << lineno << ": symbol " << id << " is a function" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "defined-as-function", "symbol " + id + " is a function"});
     }
 
     void errorUndef(int lineno,
         const std::string & id) {
         // Report an error for the usage of an undefined variable.
-        std::cout << "line " << lineno << ": variable " << id << " is not defined" << std::endl;
-        exit(0); // Exit the program as the error is critical.
+        dovakh({lineno, "undefined", "variable " + id + " is not defined"});
     }
 
     void errorSyn(int lineno) {
-        // Report a syntax error in the input.
-        std::cout << "line " << lineno << ": syntax error\n";
+        // Report a syntax error in the input. The parser cannot go on, so the program ends here in every mode,
+        // with the errors collected before it.
+        dovakh({lineno, "syntax", "syntax error"});
+        printDiagnostics(std::cout);
         exit(0); // Exit the program as the error is critical.
     }
 
     void errorLex(int lineno) {
-        // Report a lexical error in the input.
-        std::cout << "line " << lineno << ": lexical error\n";
+        // Report a lexical error in the input, which ends the program in every mode like a syntax error.
+        dovakh({lineno, "lexical", "lexical error"});
+        printDiagnostics(std::cout);
         exit(0); // Exit the program as the error is critical.
     }
 
@@ -972,6 +1217,13 @@ namespace output {
         // Remove all variables declared in the current frame from the symbol table.
         if (!MisparMishtaneNokhehi.empty()) {
             for (int haIndeks = 0; haIndeks < MisparMishtaneNokhehi.back(); haIndeks++) {
+                // Bring back the entry the variable shadowed, if there is one.
+                const Mishtane & mishtane = mishtaneMisgeret.back();
+                if (mishtane.mutsal < 0) {
+                    tavlatSmalim.erase(mishtane.symbol);
+                } else {
+                    tavlatSmalim[mishtane.symbol] = mishtane.mutsal;
+                }
                 mishtaneMisgeret.pop_back(); // Remove the variable from the scope.
                 moneMishtanim -= 1; // Decrement the variable count.
             }
@@ -983,4 +1235,33 @@ namespace output {
         // Add a new frame to track the number of variables in the current scope.
         MisparMishtaneNokhehi.push_back(0);
     }
-}
\ No newline at end of file
+
+    const Mishtane * hipusMishtane(symbols::Symbol symbol) {
+        // Find the innermost variable or parameter of this name in scope, or nullptr if there is none.
+        auto knisa = tavlatSmalim.find(symbol);
+        return knisa == tavlatSmalim.end() ? nullptr : & mishtaneMisgeret[knisa -> second];
+    }
+
+    void hosafatMishtane(const ast::ID & id, ast::BuiltInType type, int heist, int shura, ast::Kind sug) {
+        // Add the variable to the scope, shadowing any entry of the same name until its frame is left.
+        auto knisa = tavlatSmalim.find(id.symbol);
+        int mutsal = knisa == tavlatSmalim.end() ? -1 : knisa -> second;
+        mishtaneMisgeret.push_back({id.symbol, type, heist, shura, mutsal, sug});
+        tavlatSmalim[id.symbol] = static_cast < int > (mishtaneMisgeret.size()) - 1;
+    }
+
+    const Funktsiyya * hipusFunktsiyya(symbols::Symbol symbol) {
+        // Find the global function of this name, or nullptr if there is none.
+        auto knisa = tavlatFunktsiyyot.find(symbol);
+        return knisa == tavlatFunktsiyyot.end() ? nullptr : & HatsharatMishtaneGlobali[knisa -> second];
+    }
+
+    const Funktsiyya & hosafatFunktsiyya(const ast::ID & id, ast::BuiltInType tippusHahzara,
+                                         std::vector < ast::BuiltInType > tippusim) {
+        // Add the function to the global function table. A name is only ever added once, since declaring it again
+        // is an error and the first declaration stays.
+        HatsharatMishtaneGlobali.push_back({& id.value, id.symbol, tippusHahzara, std::move(tippusim)});
+        tavlatFunktsiyyot.emplace(id.symbol, static_cast < int > (HatsharatMishtaneGlobali.size()) - 1);
+        return HatsharatMishtaneGlobali.back();
+    }
+}
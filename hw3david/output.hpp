@@ -1,7 +1,10 @@
 #ifndef OUTPUT_HPP
 #define OUTPUT_HPP
 
+#include <cstdint>
 #include <vector>
+#include <unordered_map>
+#include <memory>
 #include <iostream>
 #include <stack>
 #include <string>
@@ -11,7 +14,33 @@
 #include "nodes.hpp"
 
 namespace output {
-    /* Error handling functions */
+    /* How errors in the program are reported */
+    enum class Diagnostics {
+        FIRST, // Print the first error and exit, the default
+        TEXT,  // Keep checking, then print every error the way FIRST prints one, instead of the scopes
+        JSON   // Keep checking, then print every error as one JSON document, instead of the scopes
+    };
+
+    /* An error in the program, as it is collected */
+    struct Diagnostic {
+        int line;            // 0 for an error of the whole program
+        const char *kind;    // What went wrong, such as "mismatch" or "undefined"
+        std::string message; // The message, without its line
+    };
+
+    // Prints the diagnostic as the error functions print it, with its line
+    std::ostream &operator<<(std::ostream &os, const Diagnostic &diagnostic);
+
+    // Picks how errors are reported, before anything is checked
+    void reportDiagnostics(Diagnostics mode);
+
+    // Prints the collected errors, if they are printed instead of the scopes, and tells whether it did
+    bool printDiagnostics(std::ostream &os);
+
+    // The errors collected so far on this thread
+    extern thread_local std::vector<Diagnostic> divuakhim;
+
+    /* Error handling functions. Lexical and syntax errors end the program in every mode, since parsing stops there */
 
     void errorLex(int lineno);
 
@@ -38,33 +67,139 @@ namespace output {
     void errorMainMissing();
 
     void errorByteTooLarge(int lineno, int value);
+
+    void errorByteTooLarge(int lineno, const std::string &value);
+
+    void errorNumTooLarge(int lineno, const std::string &value);
     
-    extern std::vector<std::shared_ptr<ast::Node>> mishtaneMisgeret;
-    extern std::vector<int> MisparMishtaneNokhehi;
-    extern std::vector<std::shared_ptr<ast::FuncDecl>> HatsharatMishtaneGlobali;
-    extern std::vector<std::shared_ptr<ast::Node>> KriatMishtaneGlobali;
+    /* A variable or formal parameter in scope: a small record of what the checker needs to know about it, kept by
+     * value in the frame stack. The entries of one name form a stack: each one links to the entry it shadows, so
+     * leaving a frame brings the outer entry back in O(1) */
+    struct Mishtane {
+        symbols::Symbol symbol;
+        ast::BuiltInType type;
+        int heist;  // The offset emitted for it
+        int shura;  // The line it is declared on
+        int mutsal; // The index of the entry of the same name it shadows, or -1
+        ast::Kind sug; // FORMAL or VAR_DECL
+    };
+
+    extern thread_local std::vector<Mishtane> mishtaneMisgeret;
+    extern thread_local std::unordered_map<symbols::Symbol, int> tavlatSmalim;
+    extern thread_local std::vector<int> MisparMishtaneNokhehi;
+    /* A function in the global scope, with its signature worked out once when it is declared */
+    struct Funktsiyya {
+        const std::string *shem; // The interned name, which lives as long as the program
+        symbols::Symbol symbol;
+        ast::BuiltInType tippusHahzara;
+        std::vector<ast::BuiltInType> tippusim; // The types of the parameters, in order
+    };
+
+    extern thread_local std::vector<Funktsiyya> HatsharatMishtaneGlobali;
+    extern thread_local std::unordered_map<symbols::Symbol, int> tavlatFunktsiyyot;
+    extern thread_local std::vector<std::shared_ptr<ast::Node>> KriatMishtaneGlobali;
 
     void enrtyFrame();
     void exitFrame();
-    extern ast::BuiltInType returnType;
-    extern int moneMishtanim;
-    extern bool zoKria;
-    extern bool shimush;
+    const Mishtane *hipusMishtane(symbols::Symbol symbol);
+    void hosafatMishtane(const ast::ID &id, ast::BuiltInType type, int heist, int shura, ast::Kind sug);
+    const Funktsiyya *hipusFunktsiyya(symbols::Symbol symbol);
+    const Funktsiyya &hosafatFunktsiyya(const ast::ID &id, ast::BuiltInType tippusHahzara,
+                                        std::vector<ast::BuiltInType> tippusim);
+    extern thread_local ast::BuiltInType returnType;
+    extern thread_local int moneMishtanim;
+    extern thread_local bool zoKria;
+    extern thread_local bool shimush;
 
     /* ScopePrinter class
      * This class is used to print scopes in a human-readable format.
      */
-    class ScopePrinter : public Visitor {
+    class ScopePrinter final : public Visitor {
     private:
+        /* The checker walks the tree with an explicit stack instead of recursing through accept, so the depth of
+         * a program is limited only by memory. A visit does what comes before its first child right away and
+         * schedules the rest: its children, and the steps between and after them. walk() runs the scheduled
+         * tasks, the tasks of one visit in the order it scheduled them */
+        enum class Step : std::uint8_t {
+            VISIT,         // Visit the node
+            FINISH,        // Check the node once its children are visited
+            CHECK_DEF,     // Check that a VarDecl does not redefine a symbol
+            OPEN_SCOPE,    // beginScope() and enrtyFrame()
+            CLOSE_SCOPE,   // endScope() and exitFrame()
+            USE_ON,        // Turn the variable usage checks back on
+            CALL_OFF,      // Leave the function name of a call
+            LEAVE_LOOP,    // Leave the body of a while loop
+            RESET_OFFSETS  // Start counting variable offsets from 0
+        };
+
+        struct Task {
+            Step step;
+            ast::Node *node;
+        };
+
+        // The tasks still to run, the next one last, and the tasks the running one has scheduled so far
+        std::vector<Task> tasks;
+        std::vector<Task> pending;
+        bool walking = false;
+
+        void schedule(ast::Node &node);
+
+        void schedule(Step step, ast::Node *node = nullptr);
+
+        // Schedules a statement, in a scope of its own if it is written in braces
+        void scheduleScoped(ast::Statement &statement);
+
+        // Runs the scheduled tasks until none is left. Does nothing when called from a task, since the loop that
+        // runs that task picks up what it scheduled
+        void walk();
+
+        void run(const Task &task);
+
+        // The FINISH steps of the nodes that check something after their children
+        void finish(ast::Funcs &node);
+
+        void finish(ast::Formal &node);
+
+        void finish(ast::Assign &node);
+
+        void finish(ast::VarDecl &node);
+
+        void finish(ast::While &node);
+
+        void finish(ast::If &node);
+
+        void finish(ast::Return &node);
+
+        void finish(ast::Call &node);
+
+        void finish(ast::Or &node);
+
+        void finish(ast::And &node);
+
+        void finish(ast::Not &node);
+
+        void finish(ast::Cast &node);
+
+        void finish(ast::RelOp &node);
+
+        void finish(ast::BinOp &node);
+
+        void checkDef(ast::VarDecl &node);
+
+        // Checks the bodies of the functions on worker threads and appends their scopes to buffer in source order
+        void checkInParallel(ast::Funcs &node);
 
         int hafsakaVeHemshekhHukiyim = 0;
 
         std::stringstream globalsBuffer;
         std::stringstream buffer;
         int indentLevel;
+        unsigned jobs;
 
     public:
-        ScopePrinter();
+        /* With more than one job, the function bodies are checked in parallel once every signature is known. The
+         * output, and the error if there is one, are those of a serial run */
+        explicit ScopePrinter(unsigned jobs = 1);
 
         void beginScope();
 
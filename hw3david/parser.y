@@ -2,24 +2,46 @@
 #include <iostream>
 #include "nodes.hpp"
 #include "output.hpp"
+#include "../scanner/arena.hpp"
 #include <string>
 //#include "token.hpp"
 
-// bison declarations
-extern int yylineno;
-extern int yylex();
-void yyerror(const char*);
-
-
-
 using namespace std;
 using namespace ast;
 using namespace output;
-
-// root of the AST, set by the parser and used by other parts of the compiler
-shared_ptr<Node> program; 
 %}
 
+// A C++ parser with typed semantic values: every token and nonterminal below carries the type of the node it
+// stands for, so the actions need no casts. The tokens come from the Source given to the parser, the nodes are
+// allocated in arena, and the root of the AST is stored in program
+%skeleton "lalr1.cc"
+%require "3.2"
+%define api.value.type variant
+
+%code requires {
+#include <memory>
+#include "nodes.hpp"
+
+namespace tokenstream {
+    class Source;
+}
+
+namespace ast {
+    class Arena;
+}
+}
+
+%code {
+#include "tokenstream.hpp"
+
+// bison declarations
+extern thread_local int yylineno;
+extern int yylex(yy::parser::value_type *value, tokenstream::Source &tokens, ast::Arena &arena);
+}
+
+%parse-param { tokenstream::Source &tokens } { ast::Arena &arena } { std::shared_ptr<ast::Node> &program }
+%lex-param { tokenstream::Source &tokens } { ast::Arena &arena }
+
 // Define tokens here
 %token VOID
 %token INT
@@ -43,10 +65,10 @@ shared_ptr<Node> program;
 %token LBRACE
 %token RBRACE
 %token ASSIGN
-%token ID
-%token NUM
-%token NUM_B
-%token STRING
+%token <std::shared_ptr<ast::ID>> ID
+%token <std::shared_ptr<ast::Num>> NUM
+%token <std::shared_ptr<ast::NumB>> NUM_B
+%token <std::shared_ptr<ast::String>> STRING
 %token R_EQ
 %token R_NE
 %token R_LT
@@ -57,6 +79,17 @@ shared_ptr<Node> program;
 %token B_SUB
 %token B_MUL
 %token B_DIV
+// The node each nonterminal builds
+%type <std::shared_ptr<ast::Funcs>> Funcs
+%type <std::shared_ptr<ast::FuncDecl>> FuncDecl
+%type <std::shared_ptr<ast::Type>> RetType Type
+%type <std::shared_ptr<ast::Formals>> Formals FormalsList
+%type <std::shared_ptr<ast::Formal>> FormalDecl
+%type <std::shared_ptr<ast::Statements>> Statements
+%type <std::shared_ptr<ast::Statement>> Statement
+%type <std::shared_ptr<ast::Call>> Call
+%type <std::shared_ptr<ast::ExpList>> ExpList
+%type <std::shared_ptr<ast::Exp>> Exp
 // Define precedence and associativity here
 %right ASSIGN
 %left OR
@@ -77,101 +110,102 @@ shared_ptr<Node> program;
 Program:  Funcs { program = $1; }
 ;
 
-// Grammar for functions
-Funcs:      { $$ = make_shared<Funcs>(); } 
-        | FuncDecl Funcs {  $$ = $2; dynamic_pointer_cast<ast::Funcs>($$)->push_front(dynamic_pointer_cast<ast::FuncDecl>($1)); }
+// Grammar for functions. The lists below are left-recursive, so they are built with push_back in linear time
+// and the parser stack stays flat however long they get
+Funcs:      { $$ = arena.make<Funcs>(); } 
+        | Funcs FuncDecl {  $$ = $1; $$->push_back($2); }
 ;
 
 // Function declarations
-FuncDecl: RetType ID LPAREN Formals RPAREN LBRACE Statements RBRACE {$$ = make_shared<ast::FuncDecl>(dynamic_pointer_cast<ast::ID>($2), dynamic_pointer_cast<ast::Type>($1), dynamic_pointer_cast<ast::Formals>($4), dynamic_pointer_cast<ast::Statements>($7)); } 
+FuncDecl: RetType ID LPAREN Formals RPAREN LBRACE Statements RBRACE {$$ = arena.make<ast::FuncDecl>($2, $1, $4, $7); } 
 ;
 
 // Return type for functions
 RetType: Type { $$ = $1; }
-        | VOID { $$ = make_shared<ast::Type>(ast::BuiltInType::VOID); }       
+        | VOID { $$ = arena.make<ast::Type>(ast::BuiltInType::VOID); }       
 ;
 
 // Formals for function parameters
-Formals: { $$ = make_shared<ast::Formals>(); }
+Formals: { $$ = arena.make<ast::Formals>(); }
          | FormalsList { $$ = $1; }
 ;
 
-FormalsList: FormalDecl { $$ = make_shared<ast::Formals>(dynamic_pointer_cast<ast::Formal>($1)); }
-           | FormalDecl COMMA FormalsList { $$ = $3; dynamic_pointer_cast<ast::Formals>($$)->push_front(dynamic_pointer_cast<ast::Formal>($1)); }
+FormalsList: FormalDecl { $$ = arena.make<ast::Formals>($1); }
+           | FormalsList COMMA FormalDecl { $$ = $1; $$->push_back($3); }
 ;
 
 // Formal declaration for parameters
-FormalDecl: Type ID { $$ = make_shared<ast::Formal>(dynamic_pointer_cast<ast::ID>($2), dynamic_pointer_cast<ast::Type>($1)); }
+FormalDecl: Type ID { $$ = arena.make<ast::Formal>($2, $1); }
 ;
 
 // Statements block
-Statements: Statement { $$ = make_shared<ast::Statements>(dynamic_pointer_cast<Statement>($1)); }
-         | Statements Statement { $$ = $1; dynamic_pointer_cast<Statements>($$)->push_back(dynamic_pointer_cast<Statement>($2)); }
+Statements: Statement { $$ = arena.make<ast::Statements>($1); }
+         | Statements Statement { $$ = $1; $$->push_back($2); }
 ;
 
 // Single statement rule
-Statement: LBRACE Statements RBRACE { (dynamic_pointer_cast<ast::Statements>($2))->zeSograyim = true; $$ = $2; }   
-         | Type ID SC { $$ = make_shared<ast::VarDecl>(dynamic_pointer_cast<ast::ID>($2), dynamic_pointer_cast<ast::Type>($1)); }
-         | Type ID ASSIGN Exp SC { $$ = make_shared<ast::VarDecl>(dynamic_pointer_cast<ast::ID>($2), dynamic_pointer_cast<ast::Type>($1), dynamic_pointer_cast<ast::Exp>($4)); }
-         | ID ASSIGN Exp SC { $$ = make_shared<ast::Assign>(dynamic_pointer_cast<ast::ID>($1), dynamic_pointer_cast<ast::Exp>($3)); }
+Statement: LBRACE Statements RBRACE { $2->zeSograyim = true; $$ = $2; }   
+         | Type ID SC { $$ = arena.make<ast::VarDecl>($2, $1); }
+         | Type ID ASSIGN Exp SC { $$ = arena.make<ast::VarDecl>($2, $1, $4); }
+         | ID ASSIGN Exp SC { $$ = arena.make<ast::Assign>($1, $3); }
          | Call SC { $$ = $1; }
-         | RETURN SC { $$ = make_shared<ast::Return>(); }
-         | RETURN Exp SC { $$ = make_shared<ast::Return>(dynamic_pointer_cast<ast::Exp>($2)); }
-         | IF LPAREN Exp RPAREN Statement { $$ = make_shared<ast::If>(dynamic_pointer_cast<ast::Exp>($3), dynamic_pointer_cast<ast::Statement>($5)); }
-         | IF LPAREN Exp RPAREN Statement ELSE Statement { $$ = make_shared<ast::If>(dynamic_pointer_cast<ast::Exp>($3), dynamic_pointer_cast<ast::Statement>($5), dynamic_pointer_cast<ast::Statement>($7)); }
-         | WHILE LPAREN Exp RPAREN Statement { $$ = make_shared<ast::While>(dynamic_pointer_cast<ast::Exp>($3), dynamic_pointer_cast<ast::Statement>($5)); }
-         | BREAK SC { $$ = make_shared<ast::Break>(); }
-         | CONTINUE SC { $$ = make_shared<ast::Continue>(); }
+         | RETURN SC { $$ = arena.make<ast::Return>(); }
+         | RETURN Exp SC { $$ = arena.make<ast::Return>($2); }
+         | IF LPAREN Exp RPAREN Statement { $$ = arena.make<ast::If>($3, $5); }
+         | IF LPAREN Exp RPAREN Statement ELSE Statement { $$ = arena.make<ast::If>($3, $5, $7); }
+         | WHILE LPAREN Exp RPAREN Statement { $$ = arena.make<ast::While>($3, $5); }
+         | BREAK SC { $$ = arena.make<ast::Break>(); }
+         | CONTINUE SC { $$ = arena.make<ast::Continue>(); }
 ;
 
 // Function call
-Call: ID LPAREN ExpList RPAREN { $$ = make_shared<ast::Call>(dynamic_pointer_cast<ast::ID>($1), dynamic_pointer_cast<ast::ExpList>($3)); }
-         | ID LPAREN RPAREN { $$ = make_shared<ast::Call>(dynamic_pointer_cast<ast::ID>($1)); }
+Call: ID LPAREN ExpList RPAREN { $$ = arena.make<ast::Call>($1, $3); }
+         | ID LPAREN RPAREN { $$ = arena.make<ast::Call>($1, arena.make<ast::ExpList>()); }
 ;
 
 // Expression list
-ExpList: Exp { $$ = make_shared<ast::ExpList>(dynamic_pointer_cast<ast::Exp>($1)); }
-         | Exp COMMA ExpList { $$ = $3; dynamic_pointer_cast<ast::ExpList>($$)->push_front(dynamic_pointer_cast<ast::Exp>($1)); }
+ExpList: Exp { $$ = arena.make<ast::ExpList>($1); }
+         | ExpList COMMA Exp { $$ = $1; $$->push_back($3); }
 ;
 
 // Type definitions
-Type: INT { $$ = make_shared<ast::Type>(ast::BuiltInType::INT); }
-        | BYTE { $$ = make_shared<ast::Type>(ast::BuiltInType::BYTE); }
-        | BOOL { $$ = make_shared<ast::Type>(ast::BuiltInType::BOOL); }
+Type: INT { $$ = arena.make<ast::Type>(ast::BuiltInType::INT); }
+        | BYTE { $$ = arena.make<ast::Type>(ast::BuiltInType::BYTE); }
+        | BOOL { $$ = arena.make<ast::Type>(ast::BuiltInType::BOOL); }
 ;
 
 // Expression rules
 Exp: LPAREN Exp RPAREN { $$ = $2; }
         | Exp B_ADD Exp { 
-            $$ = make_shared<ast::BinOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::BinOpType::ADD); }
+            $$ = arena.make<ast::BinOp>($1, $3, ast::BinOpType::ADD); }
         | Exp B_SUB Exp { 
-            $$ = make_shared<ast::BinOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::BinOpType::SUB); }
+            $$ = arena.make<ast::BinOp>($1, $3, ast::BinOpType::SUB); }
         | Exp B_MUL Exp { 
-            $$ = make_shared<ast::BinOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::BinOpType::MUL); }
+            $$ = arena.make<ast::BinOp>($1, $3, ast::BinOpType::MUL); }
         | Exp B_DIV Exp { 
-            $$ = make_shared<ast::BinOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::BinOpType::DIV); }
+            $$ = arena.make<ast::BinOp>($1, $3, ast::BinOpType::DIV); }
         | ID { $$ = $1; }
         | Call { $$ = $1; }
         | NUM { $$ = $1; }
         | NUM_B { $$ = $1; }
         | STRING { $$ = $1; }
-        | TRUE { $$ = make_shared<ast::Bool>(true); }
-        | FALSE { $$ = make_shared<ast::Bool>(false); }
-        | NOT Exp { $$ = make_shared<ast::Not>(dynamic_pointer_cast<ast::Exp>($2)); }
-        | Exp AND Exp { $$ = make_shared<ast::And>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3)); }
-        | Exp OR Exp { $$ = make_shared<ast::Or>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3)); }
-        | Exp R_EQ Exp { $$ = make_shared<ast::RelOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::RelOpType::EQ); }
-        | Exp R_NE Exp { $$ = make_shared<ast::RelOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::RelOpType::NE); }
-        | Exp R_LT Exp { $$ = make_shared<ast::RelOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::RelOpType::LT); }
-        | Exp R_GT Exp { $$ = make_shared<ast::RelOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::RelOpType::GT); }
-        | Exp R_LE Exp { $$ = make_shared<ast::RelOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::RelOpType::LE); }
-        | Exp R_GE Exp { $$ = make_shared<ast::RelOp>(dynamic_pointer_cast<ast::Exp>($1), dynamic_pointer_cast<ast::Exp>($3), ast::RelOpType::GE); }
-        | LPAREN Type RPAREN Exp { $$ = make_shared<ast::Cast>(dynamic_pointer_cast<ast::Exp>($4), dynamic_pointer_cast<ast::Type>($2)); }
+        | TRUE { $$ = arena.make<ast::Bool>(true); }
+        | FALSE { $$ = arena.make<ast::Bool>(false); }
+        | NOT Exp { $$ = arena.make<ast::Not>($2); }
+        | Exp AND Exp { $$ = arena.make<ast::And>($1, $3); }
+        | Exp OR Exp { $$ = arena.make<ast::Or>($1, $3); }
+        | Exp R_EQ Exp { $$ = arena.make<ast::RelOp>($1, $3, ast::RelOpType::EQ); }
+        | Exp R_NE Exp { $$ = arena.make<ast::RelOp>($1, $3, ast::RelOpType::NE); }
+        | Exp R_LT Exp { $$ = arena.make<ast::RelOp>($1, $3, ast::RelOpType::LT); }
+        | Exp R_GT Exp { $$ = arena.make<ast::RelOp>($1, $3, ast::RelOpType::GT); }
+        | Exp R_LE Exp { $$ = arena.make<ast::RelOp>($1, $3, ast::RelOpType::LE); }
+        | Exp R_GE Exp { $$ = arena.make<ast::RelOp>($1, $3, ast::RelOpType::GE); }
+        | LPAREN Type RPAREN Exp { $$ = arena.make<ast::Cast>($4, $2); }
 ;
 
 %%
 
 // Error reporting
-void yyerror(const char* message) {
+void yy::parser::error(const std::string &) {
     errorSyn(yylineno); 
 }
\ No newline at end of file
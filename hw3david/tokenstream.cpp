@@ -0,0 +1,310 @@
+#include "tokenstream.hpp"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "nodes.hpp"
+#include "../scanner/arena.hpp"
+#include "output.hpp"
+#include "../scanner/literal.hpp"
+#include "parser.tab.h"
+
+// Line of the last token handed to the parser, read by the Node constructor. Each thread parses with its own
+thread_local int yylineno = 1;
+
+// Token numbers of the grammar
+using token = yy::parser::token;
+
+namespace tokenstream {
+    std::uint64_t Reader::varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (position >= data.size()) {
+                break;
+            }
+            auto byte = static_cast<std::uint8_t>(data[position++]);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        broken = true; // Cut short, or longer than any 64-bit number
+        return 0;
+    }
+
+    /* The digits of a NUM, followed by the b of a NUM_B */
+    static bool isNumber(std::string_view text, bool byte) {
+        if (byte) {
+            if (text.size() < 2 || text.back() != 'b') {
+                return false;
+            }
+            text.remove_suffix(1);
+        }
+        return !text.empty() && text.find_first_not_of("0123456789") == std::string_view::npos;
+    }
+
+    /* The string pattern of the PARSER dialect: not empty, and only \r \n \t \" and \\ as escapes */
+    static bool isString(std::string_view text) {
+        if (text.size() < 3) {
+            return false;
+        }
+        for (std::size_t i = 1; i < text.size() - 1; ++i) {
+            if (text[i] == '\\' && std::strchr("rnt\"\\", text[++i]) == nullptr) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Reader::open(const char *path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (data.size() < 5 || data.compare(0, 4, "FCTK") != 0 || data[4] != 2) {
+            return false;
+        }
+        // Reads the whole stream once, so a truncated or corrupt file is refused here, not halfway through a parse
+        position = 5;
+        while (next() != scanner::Token::END) {}
+        if (broken) {
+            return false;
+        }
+        position = 5;
+        lexemes.clear();
+        lexeme = {};
+        line = 1;
+        error = false;
+        ended = false;
+        return true;
+    }
+
+    scanner::Token Reader::next() {
+        using scanner::Token;
+
+        if (position >= data.size()) {
+            // The END record moves past the last byte, so running out before it means the stream was cut short
+            broken = broken || !ended;
+            return Token::END;
+        }
+        auto kind = static_cast<Token>(data[position++]);
+        std::uint64_t delta = varint();
+        if (kind > Token::STRING || delta > INT32_MAX - static_cast<std::uint64_t>(line)) {
+            return refuse();
+        }
+        line += static_cast<int>(delta);
+
+        switch (kind) {
+            case Token::END:
+                // The status byte ends the stream: 0 at the end of input, 1 after a lexical error
+                if (position + 1 != data.size() || static_cast<std::uint8_t>(data[position]) > 1) {
+                    return refuse();
+                }
+                error = data[position] == 1;
+                ended = true;
+                position = data.size();
+                return kind;
+            case Token::ID:
+            case Token::NUM:
+            case Token::NUM_B:
+            case Token::STRING:
+            case Token::RELOP:
+            case Token::BINOP: {
+                std::uint64_t index = varint();
+                if (index > lexemes.size()) {
+                    return refuse();
+                }
+                if (index == lexemes.size()) {
+                    std::uint64_t length = varint();
+                    if (broken || length == 0 || length > data.size() - position) {
+                        return refuse();
+                    }
+                    lexemes.emplace_back(data.data() + position, length);
+                    position += length;
+                }
+                lexeme = lexemes[index];
+                if ((kind == Token::NUM || kind == Token::NUM_B) && !isNumber(lexeme, kind == Token::NUM_B)) {
+                    return refuse();
+                }
+                if (kind == Token::STRING && !isString(lexeme)) {
+                    return refuse();
+                }
+                break;
+            }
+            default:
+                break;
+        }
+        return broken ? refuse() : kind;
+    }
+
+    scanner::Token Reader::refuse() {
+        broken = true;
+        position = data.size();
+        return scanner::Token::END;
+    }
+
+    int Reader::lineno() const {
+        return line;
+    }
+
+    std::string_view Reader::text() const {
+        return lexeme;
+    }
+
+    bool Reader::failed() const {
+        return error;
+    }
+
+    Source::Source(scanner::Scanner &scanner) : scanner(&scanner) {}
+
+    Source::Source(Reader &reader) : reader(&reader) {}
+
+    std::string_view Source::text() const {
+        return scanner ? std::string_view(scanner->text(), scanner->length()) : reader->text();
+    }
+
+    /* Parses the digits of a NUM or NUM_B token, reporting a number too large for an int, which is 0 if checking goes
+     * on to collect more errors */
+    static int number(std::string_view digits, bool byte) {
+        int value = 0;
+        if (!literal::integer(digits.data(), digits.data() + digits.size(), value)) {
+            if (byte) {
+                output::errorByteTooLarge(yylineno, std::string(digits));
+            } else {
+                output::errorNumTooLarge(yylineno, std::string(digits));
+            }
+        }
+        return value;
+    }
+
+    static int relop(std::string_view text) {
+        if (text == "==") {
+            return token::R_EQ;
+        }
+        if (text == "!=") {
+            return token::R_NE;
+        }
+        if (text == "<=") {
+            return token::R_LE;
+        }
+        if (text == ">=") {
+            return token::R_GE;
+        }
+        return text == "<" ? token::R_LT : token::R_GT;
+    }
+
+    static int binop(std::string_view text) {
+        switch (text[0]) {
+            case '+':
+                return token::B_ADD;
+            case '-':
+                return token::B_SUB;
+            case '*':
+                return token::B_MUL;
+            default:
+                return token::B_DIV;
+        }
+    }
+
+    /* Translates the tokens of the scanner or the stream to this grammar's tokens.
+     * Brackets are not part of this language and end up as lexical errors, as they did in the scanner of this exercise */
+    int Source::next(yy::parser::value_type &value, ast::Arena &arena) {
+        using scanner::Token;
+
+        for (;;) {
+            Token kind;
+            if (scanner) {
+                kind = scanner->next();
+                yylineno = scanner->lineno();
+            } else {
+                kind = reader->next();
+                yylineno = reader->lineno();
+            }
+
+            switch (kind) {
+                case Token::END:
+                    if (reader && reader->failed()) {
+                        output::errorLex(yylineno);
+                    }
+                    return 0;
+                case Token::COMMENT:
+                    continue;
+                case Token::VOID:
+                    return token::VOID;
+                case Token::INT:
+                    return token::INT;
+                case Token::BYTE:
+                    return token::BYTE;
+                case Token::BOOL:
+                    return token::BOOL;
+                case Token::AND:
+                    return token::AND;
+                case Token::OR:
+                    return token::OR;
+                case Token::NOT:
+                    return token::NOT;
+                case Token::TRUE:
+                    return token::TRUE;
+                case Token::FALSE:
+                    return token::FALSE;
+                case Token::RETURN:
+                    return token::RETURN;
+                case Token::IF:
+                    return token::IF;
+                case Token::ELSE:
+                    return token::ELSE;
+                case Token::WHILE:
+                    return token::WHILE;
+                case Token::BREAK:
+                    return token::BREAK;
+                case Token::CONTINUE:
+                    return token::CONTINUE;
+                case Token::SC:
+                    return token::SC;
+                case Token::COMMA:
+                    return token::COMMA;
+                case Token::LPAREN:
+                    return token::LPAREN;
+                case Token::RPAREN:
+                    return token::RPAREN;
+                case Token::LBRACE:
+                    return token::LBRACE;
+                case Token::RBRACE:
+                    return token::RBRACE;
+                case Token::ASSIGN:
+                    return token::ASSIGN;
+                case Token::RELOP:
+                    return relop(text());
+                case Token::BINOP:
+                    return binop(text());
+                case Token::ID: {
+                    // Interned here, so the checker compares names by their symbols
+                    std::string_view name = text();
+                    value.emplace<std::shared_ptr<ast::ID>>(arena.make<ast::ID>(name.data(), name.size()));
+                    return token::ID;
+                }
+                case Token::NUM:
+                    value.emplace<std::shared_ptr<ast::Num>>(arena.make<ast::Num>(number(text(), false)));
+                    return token::NUM;
+                case Token::NUM_B: {
+                    std::string_view digits = text();
+                    digits.remove_suffix(1);
+                    value.emplace<std::shared_ptr<ast::NumB>>(arena.make<ast::NumB>(number(digits, true)));
+                    return token::NUM_B;
+                }
+                case Token::STRING: {
+                    std::string_view string = text();
+                    value.emplace<std::shared_ptr<ast::String>>(arena.make<ast::String>(string.data(), string.size()));
+                    return token::STRING;
+                }
+                default:
+                    output::errorLex(yylineno);
+            }
+        }
+    }
+}
+
+/* Called by the parser with the Source it was constructed with */
+int yylex(yy::parser::value_type *value, tokenstream::Source &tokens, ast::Arena &arena) {
+    return tokens.next(*value, arena);
+}
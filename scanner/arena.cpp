@@ -0,0 +1,25 @@
+#include "arena.hpp"
+
+namespace ast {
+
+    Arena::~Arena() {
+        // Newest first, so a parent goes before its children
+        for (Header *header = last; header; header = header->previous) {
+            header->destroy(reinterpret_cast<char *>(header) + HEADER_SIZE);
+        }
+    }
+
+    void *Arena::allocate(std::size_t size) {
+        size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        if (size > remaining) {
+            std::size_t blockSize = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+            blocks.emplace_back(new char[blockSize]);
+            position = blocks.back().get();
+            remaining = blockSize;
+        }
+        void *memory = position;
+        position += size;
+        remaining -= size;
+        return memory;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ast {
+
+    /* Owns every node of one compilation. Nodes are bump-allocated in large blocks in the order the parser
+     * creates them, children before their parent, so a tree is laid out roughly in post-order. They are all
+     * destroyed and freed with the arena.
+     *
+     * make() returns a shared_ptr that neither owns nor counts the node (it aliases an empty shared_ptr), so the
+     * AST keeps its shared_ptr interface and the visitors work unchanged, but copying a pointer costs no atomic
+     * operation. Such pointers must not outlive the arena */
+    class Arena {
+    private:
+        // Placed in front of every node, linking the nodes for destruction
+        struct Header {
+            Header *previous;
+            void (*destroy)(void *node);
+        };
+
+        static constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+        static constexpr std::size_t HEADER_SIZE = (sizeof(Header) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        static constexpr std::size_t BLOCK_SIZE = 1 << 16;
+
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char *position = nullptr;
+        std::size_t remaining = 0;
+        Header *last = nullptr;
+
+        void *allocate(std::size_t size);
+
+    public:
+        Arena() = default;
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        ~Arena();
+
+        template<typename T, typename... Args>
+        std::shared_ptr<T> make(Args &&... args) {
+            static_assert(alignof(T) <= ALIGNMENT, "over-aligned node");
+            auto *header = static_cast<Header *>(allocate(HEADER_SIZE + sizeof(T)));
+            T *node = new(reinterpret_cast<char *>(header) + HEADER_SIZE) T(std::forward<Args>(args)...);
+            header->destroy = [](void *object) { static_cast<T *>(object)->~T(); };
+            header->previous = last;
+            last = header;
+            return std::shared_ptr<T>(std::shared_ptr<T>(), node);
+        }
+    };
+}
+
+#endif //ARENA_HPP
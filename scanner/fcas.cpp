@@ -0,0 +1,240 @@
+#include "fcas.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace flat {
+
+    View Tree::view() const {
+        View view;
+        view.size = size();
+        view.kinds = kinds.data();
+        view.lines = lines.data();
+        view.payloads = payloads.data();
+        view.first = first.data();
+        view.counts = counts.data();
+        view.children = children.data();
+        view.strings = strings.data();
+        return view;
+    }
+
+    Builder::Builder(Tree &tree) : tree(tree) {}
+
+    Index Builder::append(Tag kind, int line, std::int32_t payload, const Index *begin, const Index *end) {
+        tree.kinds.push_back(kind);
+        tree.lines.push_back(line);
+        tree.payloads.push_back(payload);
+        tree.first.push_back(static_cast<Index>(tree.children.size()));
+        tree.counts.push_back(static_cast<std::uint32_t>(end - begin));
+        tree.children.insert(tree.children.end(), begin, end);
+        return tree.root();
+    }
+
+    Index Builder::add(Tag kind, int line, std::int32_t payload, std::initializer_list<Index> children) {
+        return append(kind, line, payload, children.begin(), children.end());
+    }
+
+    Index Builder::add(Tag kind, int line, std::int32_t payload, const std::vector<Index> &children) {
+        return append(kind, line, payload, children.data(), children.data() + children.size());
+    }
+
+    Index Builder::add(Tag kind, int line, std::string_view text) {
+        auto offset = static_cast<std::int32_t>(tree.strings.size());
+        tree.strings.append(text);
+        tree.strings.push_back('\0');
+        return add(kind, line, offset);
+    }
+
+    namespace {
+
+        // Whether child may be the child of parent the letter slot describes
+        bool fits(const View &tree, const Grammar &grammar, Index parent, Index child, char slot) {
+            if (child == NONE) {
+                return slot == 'E' || slot == 'S';
+            }
+            if (child >= parent) {
+                return false;
+            }
+            const Rule &rule = grammar.rules[tree.kinds[child]];
+            switch (slot) {
+                case 'e':
+                case 'E':
+                    return rule.role == Role::EXP;
+                case 's':
+                case 'S':
+                    return rule.role != Role::OTHER;
+                default:
+                    return rule.letter == slot;
+            }
+        }
+
+        /* Checks everything inflate() relies on, so a damaged or foreign file is refused instead of read out of
+         * bounds: kinds and payloads in range, the children of each node of the right kinds and before it, strings
+         * inside the NUL-terminated table, and the root kind of grammar at the root */
+        bool wellFormed(const View &tree, const Grammar &grammar, std::uint32_t children, std::uint64_t stringBytes) {
+            if (tree.size == 0 || (stringBytes && tree.strings[stringBytes - 1] != '\0')) {
+                return false;
+            }
+            for (Index node = 0; node < tree.size; ++node) {
+                if (tree.kinds[node] >= grammar.kinds ||
+                    static_cast<std::uint64_t>(tree.first[node]) + tree.counts[node] > children) {
+                    return false;
+                }
+
+                const Rule &rule = grammar.rules[tree.kinds[node]];
+                const char *signature = rule.children;
+                std::uint32_t count = tree.counts[node];
+                if (signature[0] && signature[1] == '*') {
+                    for (std::uint32_t i = 0; i < count; ++i) {
+                        if (!fits(tree, grammar, node, tree.child(node, i), signature[0])) {
+                            return false;
+                        }
+                    }
+                } else {
+                    if (std::strlen(signature) != count) {
+                        return false;
+                    }
+                    for (std::uint32_t i = 0; i < count; ++i) {
+                        if (!fits(tree, grammar, node, tree.child(node, i), signature[i])) {
+                            return false;
+                        }
+                    }
+                }
+
+                std::int32_t payload = tree.payloads[node];
+                switch (rule.payload) {
+                    case Payload::TEXT:
+                        if (payload < 0 || static_cast<std::uint64_t>(payload) >= stringBytes) {
+                            return false;
+                        }
+                        break;
+                    case Payload::RANGE:
+                        if (payload < rule.low || payload > rule.high) {
+                            return false;
+                        }
+                        break;
+                    case Payload::ANY:
+                        break;
+                }
+            }
+            return tree.kinds[tree.root()] == grammar.root;
+        }
+
+        std::uint64_t align(std::uint64_t offset) {
+            return (offset + 7) / 8 * 8;
+        }
+
+        // Writes a section at offset, padding the file up to it
+        bool put(std::FILE *file, std::uint64_t &written, std::uint64_t offset, const void *data, std::size_t size) {
+            static const char zeros[8] = {};
+            if (offset - written > sizeof(zeros) || std::fwrite(zeros, 1, offset - written, file) != offset - written ||
+                std::fwrite(data, 1, size, file) != size) {
+                return false;
+            }
+            written = offset + size;
+            return true;
+        }
+    }
+
+    bool save(const Tree &tree, const Grammar &grammar, const char *path) {
+        Header header{};
+        std::memcpy(header.magic, "FCAS", 4);
+        header.version = VERSION;
+        header.dialect = grammar.dialect;
+        header.byteOrder = ORDER;
+        header.nodes = tree.size();
+        header.children = static_cast<std::uint32_t>(tree.children.size());
+        header.stringBytes = tree.strings.size();
+        header.kindsOffset = align(sizeof(Header));
+        header.linesOffset = align(header.kindsOffset + header.nodes * sizeof(Tag));
+        header.payloadsOffset = align(header.linesOffset + header.nodes * sizeof(std::int32_t));
+        header.firstOffset = align(header.payloadsOffset + header.nodes * sizeof(std::int32_t));
+        header.countsOffset = align(header.firstOffset + header.nodes * sizeof(Index));
+        header.childrenOffset = align(header.countsOffset + header.nodes * sizeof(std::uint32_t));
+        header.stringsOffset = align(header.childrenOffset + header.children * sizeof(Index));
+
+        std::FILE *file = std::fopen(path, "wb");
+        if (!file) {
+            return false;
+        }
+        std::uint64_t written = 0;
+        bool ok = put(file, written, 0, &header, sizeof(header)) &&
+                  put(file, written, header.kindsOffset, tree.kinds.data(), tree.kinds.size() * sizeof(Tag)) &&
+                  put(file, written, header.linesOffset, tree.lines.data(), tree.lines.size() * sizeof(std::int32_t)) &&
+                  put(file, written, header.payloadsOffset, tree.payloads.data(),
+                      tree.payloads.size() * sizeof(std::int32_t)) &&
+                  put(file, written, header.firstOffset, tree.first.data(), tree.first.size() * sizeof(Index)) &&
+                  put(file, written, header.countsOffset, tree.counts.data(),
+                      tree.counts.size() * sizeof(std::uint32_t)) &&
+                  put(file, written, header.childrenOffset, tree.children.data(),
+                      tree.children.size() * sizeof(Index)) &&
+                  put(file, written, header.stringsOffset, tree.strings.data(), tree.strings.size());
+        return std::fclose(file) == 0 && ok;
+    }
+
+    Mapping::~Mapping() {
+        if (base) {
+            munmap(base, length);
+        }
+    }
+
+    bool Mapping::open(const char *path, const Grammar &grammar) {
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+            static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+            close(fd);
+            return false;
+        }
+        length = static_cast<std::size_t>(info.st_size);
+        base = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            base = nullptr;
+            return false;
+        }
+
+        const auto *bytes = static_cast<const char *>(base);
+        Header header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::memcmp(header.magic, "FCAS", 4) != 0 || header.version != VERSION ||
+            header.dialect != grammar.dialect || header.byteOrder != ORDER) {
+            return false;
+        }
+
+        // Every section must lie inside the file and be aligned for its elements
+        auto inside = [&](std::uint64_t offset, std::uint64_t count, std::size_t size) {
+            return offset % 8 == 0 && offset <= length && count <= (length - offset) / size;
+        };
+        if (!inside(header.kindsOffset, header.nodes, sizeof(Tag)) ||
+            !inside(header.linesOffset, header.nodes, sizeof(std::int32_t)) ||
+            !inside(header.payloadsOffset, header.nodes, sizeof(std::int32_t)) ||
+            !inside(header.firstOffset, header.nodes, sizeof(Index)) ||
+            !inside(header.countsOffset, header.nodes, sizeof(std::uint32_t)) ||
+            !inside(header.childrenOffset, header.children, sizeof(Index)) ||
+            !inside(header.stringsOffset, header.stringBytes, 1)) {
+            return false;
+        }
+
+        View view;
+        view.size = header.nodes;
+        view.kinds = reinterpret_cast<const Tag *>(bytes + header.kindsOffset);
+        view.lines = reinterpret_cast<const std::int32_t *>(bytes + header.linesOffset);
+        view.payloads = reinterpret_cast<const std::int32_t *>(bytes + header.payloadsOffset);
+        view.first = reinterpret_cast<const Index *>(bytes + header.firstOffset);
+        view.counts = reinterpret_cast<const std::uint32_t *>(bytes + header.countsOffset);
+        view.children = reinterpret_cast<const Index *>(bytes + header.childrenOffset);
+        view.strings = bytes + header.stringsOffset;
+        if (!wellFormed(view, grammar, header.children, header.stringBytes)) {
+            return false;
+        }
+        tree = view;
+        return true;
+    }
+}
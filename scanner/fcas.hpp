@@ -0,0 +1,178 @@
+#ifndef FCAS_HPP
+#define FCAS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* The binary AST files of --emit-ast and --load-ast, shared by hw2 and hw3. This part knows the layout of a file
+ * and checks its shape; each front end's flat.hpp adds the lowering and inflation of its own nodes, and the Grammar
+ * that says which trees of them are well formed */
+namespace flat {
+
+    // Nodes are named by their position in the tree
+    using Index = std::uint32_t;
+
+    // An absent optional child: the expression of a bare return, a missing else, an uninitialized declaration
+    constexpr Index NONE = UINT32_MAX;
+
+    // The kind of a node, as the byte the ast::Kind of its front end is stored in
+    using Tag = std::uint8_t;
+
+    /* The arrays of a tree, wherever they are stored: in a Tree, or in place in a mapped AST file */
+    struct View {
+        Index size = 0;
+        const Tag *kinds = nullptr;
+        const std::int32_t *lines = nullptr;
+        const std::int32_t *payloads = nullptr;
+        const Index *first = nullptr;
+        const std::uint32_t *counts = nullptr;
+        const Index *children = nullptr;
+        const char *strings = nullptr;
+
+        Index root() const {
+            return size - 1;
+        }
+
+        Index child(Index node, std::uint32_t position) const {
+            return children[first[node] + position];
+        }
+
+        const char *text(Index node) const {
+            return strings + payloads[node];
+        }
+    };
+
+    /* The AST as a structure of arrays. Node i has kind kinds[i], line lines[i] and payload payloads[i], and its
+     * children are children[first[i]] up to children[first[i] + counts[i] - 1]. A node is always added after its
+     * children, so the root of the program is the last node. The payload holds what is not a child, and for an ID
+     * or STRING the offset of its NUL-terminated text in strings */
+    struct Tree {
+        std::vector<Tag> kinds;
+        std::vector<std::int32_t> lines;
+        std::vector<std::int32_t> payloads;
+        std::vector<Index> first;
+        std::vector<std::uint32_t> counts;
+        std::vector<Index> children;
+        std::string strings;
+
+        Index size() const {
+            return static_cast<Index>(kinds.size());
+        }
+
+        Index root() const {
+            return size() - 1;
+        }
+
+        View view() const;
+    };
+
+    /* Appends nodes to a tree, each after its children */
+    class Builder {
+    private:
+        Tree &tree;
+
+        Index append(Tag kind, int line, std::int32_t payload, const Index *begin, const Index *end);
+
+    public:
+        explicit Builder(Tree &tree);
+
+        Index add(Tag kind, int line, std::int32_t payload, std::initializer_list<Index> children = {});
+
+        Index add(Tag kind, int line, std::int32_t payload, const std::vector<Index> &children);
+
+        // An ID or STRING, whose text goes to the string table
+        Index add(Tag kind, int line, std::string_view text);
+    };
+
+    // Where a node of a kind may stand besides the slots its letter names
+    enum class Role : std::uint8_t {
+        OTHER,
+        EXP,      // In an expression slot, and as a statement
+        STATEMENT // In a statement slot
+    };
+
+    // What the payload of a kind must be
+    enum class Payload : std::uint8_t {
+        ANY,
+        TEXT, // An offset into the string table
+        RANGE // Between low and high
+    };
+
+    /* A row of a Grammar, for one kind. children names the children the kind must have, one letter per child: e an
+     * expression, s a statement, or the letter of the kind the child must be. A capital E or S may also be absent,
+     * and a letter followed by * is any number of such children */
+    struct Rule {
+        const char *children;
+        char letter;
+        Role role;
+        Payload payload = Payload::ANY;
+        std::int32_t low = 0;
+        std::int32_t high = 0;
+    };
+
+    /* The nodes of a front end: its dialect in the header, a rule for each kind in the order of ast::Kind, and the
+     * kind at the root of a program */
+    struct Grammar {
+        std::uint32_t dialect;
+        const Rule *rules;
+        std::size_t kinds;
+        Tag root;
+    };
+
+    /* A file is this header followed by the arrays of a tree, each at the offset the header gives from the start of
+     * the file, aligned to 8 bytes, so a mapped file is read in place. Numbers are stored in the byte order of the
+     * machine that wrote the file, which is recorded */
+    struct Header {
+        char magic[4];           // "FCAS"
+        std::uint32_t version;
+        std::uint32_t dialect;   // The front end whose nodes the file holds: 2 for hw2, 3 for hw3
+        std::uint32_t byteOrder; // ORDER, as the writer stored it
+        std::uint32_t nodes;
+        std::uint32_t children;
+        std::uint64_t stringBytes;
+        std::uint64_t kindsOffset;
+        std::uint64_t linesOffset;
+        std::uint64_t payloadsOffset;
+        std::uint64_t firstOffset;
+        std::uint64_t countsOffset;
+        std::uint64_t childrenOffset;
+        std::uint64_t stringsOffset;
+    };
+
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint32_t ORDER = 0x01020304;
+
+    /* writes tree to a binary AST file of grammar. Returns false if the file cannot be written */
+    bool save(const Tree &tree, const Grammar &grammar, const char *path);
+
+    /* A binary AST file mapped read-only. Its view points into the mapping, which must outlive every use of the
+     * view and of the AST inflate() builds from it, since STRING nodes point into its string table */
+    class Mapping {
+    private:
+        void *base = nullptr;
+        std::size_t length = 0;
+        View tree;
+
+    public:
+        Mapping() = default;
+
+        Mapping(const Mapping &) = delete;
+        Mapping &operator=(const Mapping &) = delete;
+
+        ~Mapping();
+
+        /* maps a file. Returns false if it cannot be read, or does not hold a well-formed program of grammar in this
+         * version and byte order */
+        bool open(const char *path, const Grammar &grammar);
+
+        const View &view() const {
+            return tree;
+        }
+    };
+}
+
+#endif //FCAS_HPP
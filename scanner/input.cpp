@@ -0,0 +1,82 @@
+#include "input.hpp"
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool input::map(const char *path, Buffer &buffer) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t length = (size + 2 + page - 1) / page * page;
+
+    // Reserve zeroed memory for the file plus the two sentinel bytes, then map the file over its beginning.
+    // Whatever lies past the end of the file reads as zero, so the sentinels are there without a copy.
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    if (size > 0 && mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, length);
+        close(fd);
+        return false;
+    }
+    close(fd);
+    madvise(base, length, MADV_SEQUENTIAL);
+
+    buffer.data = static_cast<char *>(base);
+    buffer.size = size;
+    buffer.mapped = length;
+    return true;
+}
+
+bool input::load(std::FILE *stream, Buffer &buffer) {
+    std::size_t capacity = 1 << 16;
+    std::size_t size = 0;
+    char *data = static_cast<char *>(std::malloc(capacity));
+
+    while (data) {
+        size += std::fread(data + size, 1, capacity - 2 - size, stream);
+        if (size < capacity - 2) {
+            break;
+        }
+        capacity *= 2;
+        char *grown = static_cast<char *>(std::realloc(data, capacity));
+        if (!grown) {
+            std::free(data);
+        }
+        data = grown;
+    }
+    if (!data || std::ferror(stream)) {
+        std::free(data);
+        return false;
+    }
+
+    data[size] = '\0';
+    data[size + 1] = '\0';
+    buffer.data = data;
+    buffer.size = size;
+    buffer.mapped = 0;
+    return true;
+}
+
+void input::release(Buffer &buffer) {
+    if (buffer.mapped) {
+        munmap(buffer.data, buffer.mapped);
+    } else {
+        std::free(buffer.data);
+    }
+    buffer = Buffer();
+}
@@ -0,0 +1,29 @@
+#ifndef INPUT_HPP
+#define INPUT_HPP
+
+#include <cstddef>
+#include <cstdio>
+
+namespace input {
+
+    /* A whole source file in memory, followed by the two NUL bytes flex expects at the end of a scan buffer */
+    struct Buffer {
+        char *data = nullptr;
+        // Bytes of source, not counting the two trailing NUL bytes
+        std::size_t size = 0;
+        // Length of the mapping behind data, 0 when data was read into the heap instead
+        std::size_t mapped = 0;
+    };
+
+    /* maps a regular file privately (flex writes into its buffer). Returns false for pipes, terminals and
+     * anything mmap refuses, so the caller can fall back to streaming the file through stdio */
+    bool map(const char *path, Buffer &buffer);
+
+    /* reads a whole stream (a pipe, a terminal) into a heap buffer with the same layout */
+    bool load(std::FILE *stream, Buffer &buffer);
+
+    /* frees a buffer filled by map or load */
+    void release(Buffer &buffer);
+}
+
+#endif //INPUT_HPP
@@ -0,0 +1,156 @@
+#include "literal.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include "simd.hpp"
+
+namespace {
+    // [0-9a-<last>A-<LAST>], the hex digit classes of the string rules
+    bool isHexUpTo(char c, char last) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= last) || (c >= 'A' && c <= last - 'a' + 'A');
+    }
+
+    int hexDigit(char c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f') {
+            return c - 'a' + 10;
+        }
+        return c - 'A' + 10;
+    }
+
+    /* Length of the invalid escape at p (a backslash) that ends INVALID_ESCAPE, or 0 */
+    std::size_t invalidEscapeLength(const char *p, const char *end) {
+        if (end - p < 2 || std::strchr("\\\"nrt0", p[1]) != nullptr) {
+            return 0;
+        }
+        if (p[1] != 'x' || end - p < 3 || p[2] == '"') {
+            return 2;
+        }
+        return (end - p < 4 || p[3] == '"') ? 3 : 4;
+    }
+}
+
+std::size_t literal::escapeLength(const char *p, const char *end, bool withNewlineHex) {
+    if (end - p < 2) {
+        return 0;
+    }
+    switch (p[1]) {
+        case '\\':
+        case '"':
+        case 'n':
+        case 'r':
+        case 't':
+        case '0':
+            return 2;
+        case 'x':
+            break;
+        default:
+            return 0;
+    }
+    if (end - p < 4) {
+        return 0;
+    }
+    char high = p[2];
+    char low = p[3];
+    bool valid = (high == '7' && isHexUpTo(low, 'e')) ||
+                 (high >= '2' && high <= '6' && isHexUpTo(low, 'f')) ||
+                 (withNewlineHex && high == '0' && (low == '9' || low == 'a' || low == 'A' || low == 'd' || low == 'D'));
+    return valid ? 4 : 0;
+}
+
+const char *literal::decode(const char *p, const char *end, std::string &value) {
+    bool terminated = false;
+    value.clear();
+
+    for (const char *q = p + 1;;) {
+        const char *stop = simd::findStringStop(q, end);
+        if (!terminated) {
+            value.append(q, stop - q);
+        }
+        if (stop == end || *stop != '\\') {
+            return stop;
+        }
+        std::size_t escape = escapeLength(stop, end, true);
+        if (!escape) {
+            return stop;
+        }
+        if (!terminated) {
+            switch (stop[1]) {
+                case 't':
+                    value += '\t';
+                    break;
+                case 'n':
+                    value += '\n';
+                    break;
+                case 'r':
+                    value += '\r';
+                    break;
+                case '0':
+                    terminated = true;
+                    break;
+                case 'x':
+                    value += static_cast<char>((hexDigit(stop[2]) << 4) | hexDigit(stop[3]));
+                    break;
+                default:  // \\ and \"
+                    value += stop[1];
+                    break;
+            }
+        }
+        q = stop + escape;
+    }
+}
+
+literal::Match literal::match(const char *p, const char *end, std::string &value) {
+    // PATTERN_OF_STRING: a body of plain characters and valid escapes closed by a quote on the same line
+    const char *stop = decode(p, end, value);
+    std::size_t stringLength = (stop != end && *stop == '"') ? stop + 1 - p : 0;
+
+    // UNCLOSED_STRING: the longest body without the closing quote. It always matches at least the quote itself
+    const char *q = p + 1;
+    for (;;) {
+        q = simd::findStringStop(q, end);
+        std::size_t escape = (q != end && *q == '\\') ? escapeLength(q, end, false) : 0;
+        if (!escape) {
+            break;
+        }
+        q += escape;
+    }
+    std::size_t unclosedLength = q - p;
+
+    // INVALID_ESCAPE: a body that may contain quotes, followed by a backslash that starts no valid escape.
+    // Every backslash the body can reach is a candidate end; flex keeps the one that ends furthest
+    std::size_t invalidLength = 0;
+    for (q = p + 1;;) {
+        q = simd::findEscapeOrLineEnd(q, end);
+        if (q == end || *q != '\\') {
+            break;
+        }
+        std::size_t invalid = invalidEscapeLength(q, end);
+        if (invalid) {
+            invalidLength = std::max(invalidLength, static_cast<std::size_t>(q + invalid - p));
+        }
+        std::size_t escape = escapeLength(q, end, false);
+        if (!escape) {
+            break;
+        }
+        q += escape;
+    }
+
+    if (stringLength && stringLength >= invalidLength && stringLength >= unclosedLength) {
+        return {PATTERN_OF_STRING, stringLength};
+    }
+    if (invalidLength && invalidLength >= unclosedLength) {
+        return {INVALID_ESCAPE, invalidLength};
+    }
+    return {UNCLOSED_STRING, unclosedLength};
+}
+
+const char *literal::invalidSequence(const char *text, std::size_t length) {
+    return static_cast<const char *>(memrchr(text, '\\', length)) + 1;
+}
+
+bool literal::integer(const char *first, const char *last, int &value) {
+    return std::from_chars(first, last, value).ec == std::errc();
+}
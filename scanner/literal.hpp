@@ -0,0 +1,55 @@
+#ifndef LITERAL_HPP
+#define LITERAL_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace literal {
+
+    /* The string rules of hw1, as scanner.lex gives them to flex. The hand-written lexer has no DFA, so match()
+     * below decides which of these the literal is, as flex would:
+     *
+     *   PATTERN_OF_STRING  ["]((\\x[0][9aAdD]|\\x[7][0-9a-eA-E]|\\x[2-6][0-9a-fA-F]|\\[\\\"nrt0]|[^\"\\\n\r])*["])
+     *   INVALID_ESCAPE     ["]((\\x[7][0-9a-eA-E]|\\x[2-6][0-9a-fA-F]|\\[\\\"nrt0]|[^\\\n\r])*)
+     *                      ([\\][^\\\"nrt0]|[\\][x]|[\\][x][^"]|[\\][x][^"][^"])
+     *   UNCLOSED_STRING    ["](\\x[7][0-9a-eA-E]|\\x[2-6][0-9a-fA-F]|\\[\\\"nrt0]|[^\\\"\n\r])*
+     */
+    enum Rule {
+        PATTERN_OF_STRING,
+        INVALID_ESCAPE,
+        UNCLOSED_STRING
+    };
+
+    /* Longest match of the string rules at an opening quote */
+    struct Match {
+        Rule rule;
+        // Length of the matched text, opening quote included
+        std::size_t length;
+    };
+
+    /* length of the escape sequence at p (a backslash) accepted inside a string body, or 0. withNewlineHex
+     * selects PATTERN_OF_STRING, the only rule that also accepts \x09, \x0A and \x0D */
+    std::size_t escapeLength(const char *p, const char *end, bool withNewlineHex);
+
+    /* decodes the literal whose opening quote is at p into value, in one pass: plain runs are found with a vector
+     * search for the next quote, backslash or line end and appended whole. value is cleared first but keeps its
+     * capacity, so one string serves every token. A \0 escape ends the value but not the literal. Returns where
+     * the body stopped: the closing quote, a line end, end, or the backslash of the first escape sequence
+     * PATTERN_OF_STRING does not accept */
+    const char *decode(const char *p, const char *end, std::string &value);
+
+    /* matches PATTERN_OF_STRING, INVALID_ESCAPE and UNCLOSED_STRING at p (an opening quote) and picks the winner
+     * the way flex does: the longest match, and the earlier rule on a tie. Like flex it may look past the end of
+     * the line, since INVALID_ESCAPE accepts any character after a backslash. When PATTERN_OF_STRING wins its
+     * decoded value is left in value */
+    Match match(const char *p, const char *end, std::string &value);
+
+    /* the sequence reported for an INVALID_ESCAPE match: whatever follows the last backslash of the matched text */
+    const char *invalidSequence(const char *text, std::size_t length);
+
+    /* parses the decimal digits in [first, last) into value with std::from_chars, without a temporary string.
+     * Returns false, leaving value unchanged, if the number does not fit in an int */
+    bool integer(const char *first, const char *last, int &value);
+}
+
+#endif //LITERAL_HPP
@@ -0,0 +1,93 @@
+#ifndef SCANNER_HPP
+#define SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace scanner {
+
+    /* Token kinds, numbered as tokentype in hw1/tokens.hpp, followed by the lexical errors */
+    enum class Token : std::uint8_t {
+        END = 0,
+        VOID,
+        INT,
+        BYTE,
+        BOOL,
+        AND,
+        OR,
+        NOT,
+        TRUE,
+        FALSE,
+        RETURN,
+        IF,
+        ELSE,
+        WHILE,
+        BREAK,
+        CONTINUE,
+        SC,
+        COMMA,
+        LPAREN,
+        RPAREN,
+        LBRACE,
+        RBRACE,
+        LBRACK,
+        RBRACK,
+        ASSIGN,
+        RELOP,
+        BINOP,
+        COMMENT,
+        ID,
+        NUM,
+        NUM_B,
+        STRING,
+        UNKNOWN_CHAR,
+        UNCLOSED_STRING,
+        UNDEFINED_ESCAPE
+    };
+
+    /* The lexical rules to scan with. LEXER is the token set of hw1, with its escape sequences and error kinds.
+     * PARSER is the stricter set hw2 and hw3 parse: only \r \n \t \" and \\ in non-empty strings, a lowercase
+     * byte suffix, and anything else is an UNKNOWN_CHAR */
+    enum class Dialect {
+        LEXER,
+        PARSER
+    };
+
+    /* A reentrant flex scanner. All of its state lives in the object, so scanners on different threads
+     * do not interfere with each other */
+    class Scanner {
+    private:
+        void *state; // flex's yyscan_t
+        int line = 1;
+        std::string decoded; // flex's yyextra
+
+    public:
+        explicit Scanner(FILE *in, Dialect dialect = Dialect::LEXER);
+
+        // Scans from memory. base[size] and base[size + 1] must be NUL
+        Scanner(char *base, std::size_t size, Dialect dialect = Dialect::LEXER);
+
+        ~Scanner();
+
+        Scanner(const Scanner &) = delete;
+        Scanner &operator=(const Scanner &) = delete;
+
+        /* returns the next token, Token::END at the end of input */
+        Token next();
+
+        /* text of the last token, NUL terminated */
+        const char *text() const;
+
+        std::size_t length() const;
+
+        /* line the last token starts on */
+        int lineno() const;
+
+        /* the decoded value of the last STRING of the LEXER dialect */
+        const std::string &value() const;
+    };
+}
+
+#endif //SCANNER_HPP
@@ -0,0 +1,198 @@
+#include "simd.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86
+#endif
+
+namespace {
+    enum CharClass {
+        WHITESPACE,
+        ALNUM,
+        DIGIT,
+        LINE_END,
+        STRING_STOP,
+        ESCAPE_OR_LINE_END
+    };
+
+    template<CharClass C>
+    inline bool stops(unsigned char c) {
+        switch (C) {
+            case WHITESPACE:
+                return !(c == ' ' || c == '\t' || c == '\r' || c == '\n');
+            case ALNUM:
+                return !((c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'));
+            case DIGIT:
+                return !(c >= '0' && c <= '9');
+            case LINE_END:
+                return c == '\n' || c == '\r';
+            case STRING_STOP:
+                return c == '"' || c == '\\' || c == '\n' || c == '\r';
+            case ESCAPE_OR_LINE_END:
+                return c == '\\' || c == '\n' || c == '\r';
+        }
+        return true;
+    }
+
+    template<CharClass C>
+    const char *scalarScan(const char *p, const char *end) {
+        while (p < end && !stops<C>(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        return p;
+    }
+
+#ifdef SIMD_X86
+    /* SSE2 is part of x86-64, so these need no runtime check */
+
+    inline __m128i eq16(__m128i v, char c) {
+        return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+    }
+
+    // Bytes in [lo, hi]. Bytes above 0x7f compare as negative and fall outside every range used here
+    inline __m128i in16(__m128i v, char lo, char hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                             _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+    }
+
+    template<CharClass C>
+    inline unsigned stopMask16(__m128i v) {
+        __m128i hit;
+        switch (C) {
+            case WHITESPACE:
+                hit = _mm_or_si128(_mm_or_si128(eq16(v, ' '), eq16(v, '\t')), _mm_or_si128(eq16(v, '\r'), eq16(v, '\n')));
+                return ~_mm_movemask_epi8(hit) & 0xffffu;
+            case ALNUM:
+                hit = _mm_or_si128(in16(v, '0', '9'), in16(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'));
+                return ~_mm_movemask_epi8(hit) & 0xffffu;
+            case DIGIT:
+                return ~_mm_movemask_epi8(in16(v, '0', '9')) & 0xffffu;
+            case LINE_END:
+                return _mm_movemask_epi8(_mm_or_si128(eq16(v, '\n'), eq16(v, '\r')));
+            case STRING_STOP:
+                hit = _mm_or_si128(_mm_or_si128(eq16(v, '"'), eq16(v, '\\')), _mm_or_si128(eq16(v, '\n'), eq16(v, '\r')));
+                return _mm_movemask_epi8(hit);
+            case ESCAPE_OR_LINE_END:
+                return _mm_movemask_epi8(_mm_or_si128(eq16(v, '\\'), _mm_or_si128(eq16(v, '\n'), eq16(v, '\r'))));
+        }
+        return 1;
+    }
+
+    template<CharClass C>
+    const char *sse2Scan(const char *p, const char *end) {
+        while (end - p >= 16) {
+            unsigned mask = stopMask16<C>(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+            if (mask) {
+                return p + __builtin_ctz(mask);
+            }
+            p += 16;
+        }
+        return scalarScan<C>(p, end);
+    }
+
+    /* AVX2 versions, only called after the CPU reported support for it */
+
+    __attribute__((target("avx2"))) inline __m256i eq32(__m256i v, char c) {
+        return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c));
+    }
+
+    __attribute__((target("avx2"))) inline __m256i in32(__m256i v, char lo, char hi) {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+    }
+
+    template<CharClass C>
+    __attribute__((target("avx2"))) inline unsigned stopMask32(__m256i v) {
+        __m256i hit;
+        switch (C) {
+            case WHITESPACE:
+                hit = _mm256_or_si256(_mm256_or_si256(eq32(v, ' '), eq32(v, '\t')),
+                                      _mm256_or_si256(eq32(v, '\r'), eq32(v, '\n')));
+                return ~static_cast<unsigned>(_mm256_movemask_epi8(hit));
+            case ALNUM:
+                hit = _mm256_or_si256(in32(v, '0', '9'), in32(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z'));
+                return ~static_cast<unsigned>(_mm256_movemask_epi8(hit));
+            case DIGIT:
+                return ~static_cast<unsigned>(_mm256_movemask_epi8(in32(v, '0', '9')));
+            case LINE_END:
+                return _mm256_movemask_epi8(_mm256_or_si256(eq32(v, '\n'), eq32(v, '\r')));
+            case STRING_STOP:
+                hit = _mm256_or_si256(_mm256_or_si256(eq32(v, '"'), eq32(v, '\\')),
+                                      _mm256_or_si256(eq32(v, '\n'), eq32(v, '\r')));
+                return _mm256_movemask_epi8(hit);
+            case ESCAPE_OR_LINE_END:
+                return _mm256_movemask_epi8(_mm256_or_si256(eq32(v, '\\'), _mm256_or_si256(eq32(v, '\n'), eq32(v, '\r'))));
+        }
+        return 1;
+    }
+
+    template<CharClass C>
+    __attribute__((target("avx2"))) const char *avx2Scan(const char *p, const char *end) {
+        while (end - p >= 32) {
+            unsigned mask = stopMask32<C>(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+            if (mask) {
+                return p + __builtin_ctz(mask);
+            }
+            p += 32;
+        }
+        return sse2Scan<C>(p, end);
+    }
+#endif
+
+    typedef const char *(*Scan)(const char *, const char *);
+
+    struct Implementation {
+        const char *name;
+        Scan whitespace;
+        Scan alnum;
+        Scan digits;
+        Scan lineEnd;
+        Scan stringStop;
+        Scan escapeOrLineEnd;
+    };
+
+    const Implementation &selected() {
+        static const Implementation implementation = [] {
+#ifdef SIMD_X86
+            if (__builtin_cpu_supports("avx2")) {
+                return Implementation{"avx2", avx2Scan<WHITESPACE>, avx2Scan<ALNUM>, avx2Scan<DIGIT>,
+                                      avx2Scan<LINE_END>, avx2Scan<STRING_STOP>, avx2Scan<ESCAPE_OR_LINE_END>};
+            }
+            return Implementation{"sse2", sse2Scan<WHITESPACE>, sse2Scan<ALNUM>, sse2Scan<DIGIT>,
+                                  sse2Scan<LINE_END>, sse2Scan<STRING_STOP>, sse2Scan<ESCAPE_OR_LINE_END>};
+#else
+            return Implementation{"scalar", scalarScan<WHITESPACE>, scalarScan<ALNUM>, scalarScan<DIGIT>,
+                                  scalarScan<LINE_END>, scalarScan<STRING_STOP>, scalarScan<ESCAPE_OR_LINE_END>};
+#endif
+        }();
+        return implementation;
+    }
+}
+
+const char *simd::skipWhitespace(const char *p, const char *end) {
+    return selected().whitespace(p, end);
+}
+
+const char *simd::skipAlnum(const char *p, const char *end) {
+    return selected().alnum(p, end);
+}
+
+const char *simd::skipDigits(const char *p, const char *end) {
+    return selected().digits(p, end);
+}
+
+const char *simd::findLineEnd(const char *p, const char *end) {
+    return selected().lineEnd(p, end);
+}
+
+const char *simd::findStringStop(const char *p, const char *end) {
+    return selected().stringStop(p, end);
+}
+
+const char *simd::findEscapeOrLineEnd(const char *p, const char *end) {
+    return selected().escapeOrLineEnd(p, end);
+}
+
+const char *simd::implementation() {
+    return selected().name;
+}
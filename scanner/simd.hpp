@@ -0,0 +1,31 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+namespace simd {
+
+    /* Byte scans used by the hand-written lexer. Each returns the first position in [p, end) that stops the scan,
+     * or end. The vector width (AVX2, SSE2 or plain bytes) is picked once, at the first call, from the running CPU */
+
+    // Stops at the first byte that is not [ \t\r\n]
+    const char *skipWhitespace(const char *p, const char *end);
+
+    // Stops at the first byte that is not [a-zA-Z0-9]
+    const char *skipAlnum(const char *p, const char *end);
+
+    // Stops at the first byte that is not [0-9]
+    const char *skipDigits(const char *p, const char *end);
+
+    // Stops at the first \n or \r
+    const char *findLineEnd(const char *p, const char *end);
+
+    // Stops at the first ", \, \n or \r
+    const char *findStringStop(const char *p, const char *end);
+
+    // Stops at the first \, \n or \r
+    const char *findEscapeOrLineEnd(const char *p, const char *end);
+
+    /* name of the selected implementation: "avx2", "sse2" or "scalar" */
+    const char *implementation();
+}
+
+#endif //SIMD_HPP
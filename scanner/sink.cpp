@@ -0,0 +1,47 @@
+#include "sink.hpp"
+#include <charconv>
+
+sink::Sink::Sink(std::FILE *file, std::size_t capacity) : file(file), capacity(capacity) {
+    buffer.reserve(capacity);
+}
+
+sink::Sink::~Sink() {
+    flush();
+}
+
+void sink::Sink::write(const char *data, std::size_t length) {
+    if (file && buffer.size() + length > capacity) {
+        flush();
+        if (length >= capacity) {
+            std::fwrite(data, 1, length, file);
+            return;
+        }
+    }
+    buffer.append(data, length);
+}
+
+void sink::Sink::put(char c) {
+    if (file && buffer.size() == capacity) {
+        flush();
+    }
+    buffer.push_back(c);
+}
+
+void sink::Sink::putNumber(int value) {
+    char digits[16];
+    char *end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    write(digits, end - digits);
+}
+
+const std::string &sink::Sink::contents() const {
+    return buffer;
+}
+
+void sink::Sink::flush() {
+    if (!file) {
+        return;
+    }
+    std::fwrite(buffer.data(), 1, buffer.size(), file);
+    std::fflush(file);
+    buffer.clear();
+}
@@ -0,0 +1,47 @@
+#ifndef SINK_HPP
+#define SINK_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace sink {
+
+    /* Buffered writer for the output of the front ends. Bytes are collected in one reusable buffer and handed to
+     * the FILE in large blocks, so nothing reaches it until the buffer fills up, flush() is called or the sink is
+     * destroyed */
+    class Sink {
+    private:
+        std::FILE *file = nullptr;
+        std::string buffer;
+        std::size_t capacity = 0;
+
+    public:
+        explicit Sink(std::FILE *file, std::size_t capacity = 1 << 16);
+
+        /* a sink without a FILE keeps everything written to it in memory, see contents() */
+        Sink() = default;
+
+        Sink(const Sink &) = delete;
+        Sink &operator=(const Sink &) = delete;
+
+        ~Sink();
+
+        const std::string &contents() const;
+
+        void write(const char *data, std::size_t length);
+
+        void write(const std::string &text) {
+            write(text.data(), text.size());
+        }
+
+        void put(char c);
+
+        void putNumber(int value);
+
+        /* hands everything buffered so far to the FILE */
+        void flush();
+    };
+}
+
+#endif //SINK_HPP
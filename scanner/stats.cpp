@@ -0,0 +1,90 @@
+#include "stats.hpp"
+
+#ifdef LEX_STATS
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    const char *const names[stats::KINDS] = {
+            "END", "VOID", "INT", "BYTE", "BOOL", "AND", "OR", "NOT", "TRUE", "FALSE", "RETURN", "IF", "ELSE",
+            "WHILE", "BREAK", "CONTINUE", "SC", "COMMA", "LPAREN", "RPAREN", "LBRACE", "RBRACE", "LBRACK",
+            "RBRACK", "ASSIGN", "RELOP", "BINOP", "COMMENT", "ID", "NUM", "NUM_B", "STRING", "UNKNOWN_CHAR",
+            "UNCLOSED_STRING", "UNDEFINED_ESCAPE", "WHITESPACE"
+    };
+
+    std::atomic<bool> on{false};
+
+    // Relaxed atomics: the totals are only read by the report, after the scanners are done
+    std::atomic<std::uint64_t> matches[stats::KINDS];
+    std::atomic<std::uint64_t> bytes[stats::KINDS];
+    std::atomic<std::uint64_t> nanoseconds[stats::KINDS];
+
+    std::uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void report() {
+        std::uint64_t totalBytes = 0;
+        std::uint64_t totalTime = 0;
+        for (std::size_t kind = 0; kind < stats::KINDS; ++kind) {
+            totalBytes += bytes[kind].load(std::memory_order_relaxed);
+            totalTime += nanoseconds[kind].load(std::memory_order_relaxed);
+        }
+
+        std::fprintf(stderr, "%-18s %12s %14s %12s %7s\n", "kind", "matches", "bytes", "time ms", "time %");
+        for (std::size_t kind = 0; kind < stats::KINDS; ++kind) {
+            std::uint64_t count = matches[kind].load(std::memory_order_relaxed);
+            if (count == 0) {
+                continue;
+            }
+            std::uint64_t time = nanoseconds[kind].load(std::memory_order_relaxed);
+            std::fprintf(stderr, "%-18s %12llu %14llu %12.3f %6.1f%%\n", names[kind],
+                         static_cast<unsigned long long>(count),
+                         static_cast<unsigned long long>(bytes[kind].load(std::memory_order_relaxed)),
+                         time / 1e6, totalTime ? 100.0 * time / totalTime : 0.0);
+        }
+
+        std::size_t comment = static_cast<std::size_t>(scanner::Token::COMMENT);
+        std::uint64_t skipped = nanoseconds[stats::WHITESPACE].load(std::memory_order_relaxed) +
+                                nanoseconds[comment].load(std::memory_order_relaxed);
+        std::fprintf(stderr, "%llu bytes in %.3f ms, %.1f%% of it skipping whitespace and comments\n",
+                     static_cast<unsigned long long>(totalBytes), totalTime / 1e6,
+                     totalTime ? 100.0 * skipped / totalTime : 0.0);
+    }
+}
+
+void stats::enable() {
+    if (!on.exchange(true)) {
+        std::atexit(report);
+    }
+}
+
+bool stats::enabled() {
+    return on.load(std::memory_order_relaxed);
+}
+
+void stats::add(std::size_t kind, std::size_t length, std::uint64_t time) {
+    matches[kind].fetch_add(1, std::memory_order_relaxed);
+    bytes[kind].fetch_add(length, std::memory_order_relaxed);
+    nanoseconds[kind].fetch_add(time, std::memory_order_relaxed);
+}
+
+void stats::Timer::start() {
+    if (enabled()) {
+        started = now();
+    }
+}
+
+void stats::Timer::record(std::size_t kind, std::size_t length) {
+    if (enabled()) {
+        std::uint64_t time = now();
+        add(kind, length, time - started);
+        started = time;
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "scanner.hpp"
+
+/* --lex-stats: matches, bytes and time per token kind, printed to stderr at exit. The counters are only built
+ * with -DLEX_STATS. Otherwise every function here is an empty inline and the hooks in the scanners compile to
+ * nothing */
+namespace stats {
+
+    // Kinds are indexed by scanner::Token, with whitespace after the error kinds
+    constexpr std::size_t WHITESPACE = static_cast<std::size_t>(scanner::Token::UNDEFINED_ESCAPE) + 1;
+    constexpr std::size_t KINDS = WHITESPACE + 1;
+
+#ifdef LEX_STATS
+    constexpr bool available = true;
+
+    /* turns counting on and registers the report with atexit(), so it is printed on error exits too */
+    void enable();
+
+    bool enabled();
+
+    /* adds one match of kind. Safe to call from several threads */
+    void add(std::size_t kind, std::size_t length, std::uint64_t nanoseconds);
+
+    /* Times consecutive matches: each record() is charged the time since the previous one, or since start() */
+    class Timer {
+    private:
+        std::uint64_t started = 0;
+
+    public:
+        void start();
+
+        void record(std::size_t kind, std::size_t length);
+    };
+#else
+    constexpr bool available = false;
+
+    inline void enable() {}
+
+    inline bool enabled() {
+        return false;
+    }
+
+    inline void add(std::size_t, std::size_t, std::uint64_t) {}
+
+    class Timer {
+    public:
+        void start() {}
+
+        void record(std::size_t, std::size_t) {}
+    };
+#endif
+}
+
+#endif //STATS_HPP
@@ -0,0 +1,62 @@
+#include "symbols.hpp"
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace {
+    // The entries in the order they were added. A deque never moves its elements, so a Name stays where it is
+    std::deque<symbols::Name> names;
+
+    // Open addressing with linear probing, at most half full. A slot holds an entry, or nullptr if it is free
+    std::vector<const symbols::Name *> slots(1 << 10);
+
+    std::mutex lock;
+
+    void grow() {
+        std::vector<const symbols::Name *> larger(slots.size() * 2);
+        std::size_t mask = larger.size() - 1;
+        for (const symbols::Name &name : names) {
+            std::size_t slot = name.hash & mask;
+            while (larger[slot]) {
+                slot = (slot + 1) & mask;
+            }
+            larger[slot] = &name;
+        }
+        slots.swap(larger);
+    }
+}
+
+namespace symbols {
+
+    std::uint32_t hash(const char *text, std::size_t length) {
+        std::uint32_t value = 2166136261u;
+        for (std::size_t i = 0; i < length; ++i) {
+            value = (value ^ static_cast<unsigned char>(text[i])) * 16777619u;
+        }
+        return value;
+    }
+
+    const Name &intern(const char *text, std::size_t length) {
+        std::uint32_t code = hash(text, length);
+        std::lock_guard<std::mutex> guard(lock);
+        std::size_t mask = slots.size() - 1;
+        std::size_t slot = code & mask;
+        for (; slots[slot]; slot = (slot + 1) & mask) {
+            const Name &name = *slots[slot];
+            if (name.hash == code && name.text.size() == length && std::memcmp(name.text.data(), text, length) == 0) {
+                return name;
+            }
+        }
+        names.push_back({std::string(text, length), code, static_cast<Symbol>(names.size())});
+        slots[slot] = &names.back();
+        if (names.size() * 2 > slots.size()) {
+            grow();
+        }
+        return names.back();
+    }
+
+    const Name &intern(const char *text) {
+        return intern(text, std::strlen(text));
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef SYMBOLS_HPP
+#define SYMBOLS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* The identifier table of hw2 and hw3. Every identifier the token source reads is interned here once, so each
+ * name has one symbol, and two names are equal exactly when their symbols are. The table is shared by the whole
+ * process and only grows: names stay valid, and symbols keep their meaning, until the process exits */
+namespace symbols {
+
+    // Symbols are numbered from 0 in the order their names were first interned
+    using Symbol = std::uint32_t;
+
+    // No name at all
+    constexpr Symbol NONE = UINT32_MAX;
+
+    /* An interned name */
+    struct Name {
+        std::string text;
+        std::uint32_t hash;
+        Symbol symbol;
+    };
+
+    /* 32-bit FNV-1a hash of a name, the hash kept in Name */
+    std::uint32_t hash(const char *text, std::size_t length);
+
+    /* returns the entry of the name, adding it if it is new. Safe to call from several threads */
+    const Name &intern(const char *text, std::size_t length);
+
+    const Name &intern(const char *text);
+}
+
+#endif //SYMBOLS_HPP
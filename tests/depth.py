@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Programs nested 10^6 deep go through every path of hw2 and hw3 without overflowing the native stack.
+
+Each shape is written on one line, so every level of nesting adds the same text to the JSON and S-expression
+dumps and the same number of lines to the tree dump. A dump of depth n is then checked against the dumps of
+depths 1 and 2. The tree dump indents each line by its depth, so it grows with the square of the depth and is
+checked at TREE_DEPTH. The checker prints the same scopes, or the same error, at any depth.
+
+DEPTH in the environment lowers the depth for a quick run.
+"""
+
+import os
+import unittest
+
+import support
+
+DEPTH = int(os.environ.get("DEPTH", 10 ** 6))
+TREE_DEPTH = min(DEPTH, 1000)
+
+SHAPES = {
+    "plus": lambda n: "void main() { int x = " + " + ".join(["1"] * n) + "; printi(x); }",
+    "not": lambda n: "void main() { bool x = " + "not " * n + "true; }",
+    "parentheses": lambda n: "void main() { int x = " + "(" * n + "1" + ")" * n + "; printi(x); }",
+    # The undefined y is only found at the bottom, so the checker walks every level before it reports it
+    "if": lambda n: "void main() {" + " if (true) {" * n + " y = 1;" + " }" * n + " }",
+}
+
+
+class Depth(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.workspace = support.Workspace()
+        cls.streams = {}
+        for shape, program in SHAPES.items():
+            for depth in {1, 2, TREE_DEPTH, DEPTH}:
+                cls.streams[shape, depth] = cls.workspace.tokens(program(depth), "%s-%d" % (shape, depth))
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.workspace.close()
+
+    def run_on(self, front_end, shape, depth, *args):
+        result = support.run(front_end, "--tokens", self.streams[shape, depth], *args)
+        self.assertEqual(result.returncode, 0, (front_end, shape, depth, args, result.stderr))
+        return result.stdout
+
+    def assertGrowsLinearly(self, measure, front_end, shape, depth, *args):
+        """measure of the output at depth is what depths 1 and 2 predict for a constant amount per level"""
+        one = measure(self.run_on(front_end, shape, 1, *args))
+        two = measure(self.run_on(front_end, shape, 2, *args))
+        deep = measure(self.run_on(front_end, shape, depth, *args))
+        self.assertEqual(deep, one + (depth - 1) * (two - one), (front_end, shape, args))
+
+    def test_json_and_sexp(self):
+        for shape in SHAPES:
+            for format in ("json", "sexp"):
+                with self.subTest(shape=shape, format=format):
+                    self.assertGrowsLinearly(len, "hw2", shape, DEPTH, "--format=" + format)
+
+    def test_tree(self):
+        for shape in SHAPES:
+            with self.subTest(shape=shape):
+                self.assertGrowsLinearly(lambda output: output.count(b"\n"), "hw2", shape, TREE_DEPTH)
+
+    def test_checker(self):
+        for shape in SHAPES:
+            with self.subTest(shape=shape):
+                shallow = self.run_on("hw3", shape, 1)
+                self.assertEqual(self.run_on("hw3", shape, DEPTH), shallow)
+                self.assertEqual(self.run_on("hw3", shape, DEPTH, "--diagnostics=json"),
+                                 self.run_on("hw3", shape, 1, "--diagnostics=json"))
+
+    def test_ast_files(self):
+        for shape in SHAPES:
+            with self.subTest(shape=shape):
+                path = self.workspace.path("%s.hw2.ast" % shape)
+                parsed = self.run_on("hw2", shape, DEPTH, "--format=sexp", "--emit-ast=" + path)
+                loaded = support.run("hw2", "--load-ast=" + path, "--format=sexp")
+                self.assertEqual(loaded.returncode, 0)
+                self.assertEqual(loaded.stdout, parsed)
+
+                path = self.workspace.path("%s.hw3.ast" % shape)
+                checked = self.run_on("hw3", shape, DEPTH, "--emit-ast=" + path)
+                loaded = support.run("hw3", "--load-ast=" + path)
+                self.assertEqual(loaded.returncode, 0)
+                self.assertEqual(loaded.stdout, checked)
+
+
+if __name__ == "__main__":
+    unittest.main()
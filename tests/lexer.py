@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""hw1 --lexer=simd prints what the flex rules of hw1 print, and --jobs prints what one job prints.
+
+Flex is emulated here from the rules of hw1/scanner.lex as they were written for flex, with the string patterns
+spelled out instead of literal::match(): at each position every rule is tried, the longest match wins and the
+earlier rule breaks a tie. The hand-written lexer is run against the emulation on fuzzed inputs built from
+fragments of the language, escapes valid and not, and stray characters. When the build has the flex scanner,
+hw1 without --lexer=simd is checked against the emulation too.
+
+--jobs splits the source at line breaks, so it is checked against one job on generated sources of 5 MB, clean and
+with a lexical error planted in the middle of the file.
+
+FUZZ in the environment sets how many fuzzed inputs are run.
+"""
+
+import os
+import random
+import re
+import sys
+import unittest
+
+import support
+
+sys.dont_write_bytecode = True  # Keeps __pycache__ out of the source tree
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "bench"))
+import generate  # noqa: E402
+
+FUZZ = int(os.environ.get("FUZZ", 400))
+JOBS_BYTES = 5 << 20
+
+KEYWORDS = [b"void", b"int", b"byte", b"bool", b"and", b"or", b"not", b"true", b"false", b"return", b"if",
+            b"else", b"while", b"break", b"continue"]
+PUNCTUATION = [(b";", b"SC"), (b",", b"COMMA"), (b"(", b"LPAREN"), (b")", b"RPAREN"), (b"{", b"LBRACE"),
+               (b"}", b"RBRACE"), (b"[", b"LBRACK"), (b"]", b"RBRACK"), (b"=", b"ASSIGN")]
+ESCAPE_BODY = rb'\\x7[0-9a-eA-E]|\\x[2-6][0-9a-fA-F]|\\[\\"nrt0]'
+
+# The rules of hw1/scanner.lex in order: the token printed for the match, or the error it ends the scan with
+RULES = [(re.escape(word), word.upper()) for word in KEYWORDS] + \
+        [(re.escape(text), name) for text, name in PUNCTUATION] + [
+    (rb"==|!=|<|>|>=|<=", b"RELOP"),
+    (rb"[+\-*/]", b"BINOP"),
+    (rb"//[^\n\r]*", b"COMMENT"),
+    (rb"[a-zA-Z][a-zA-Z0-9]*", b"ID"),
+    (rb"[1-9][0-9]*|0", b"NUM"),
+    (rb"([1-9][0-9]*|0)[bB]", b"NUM_B"),
+    # PATTERN_OF_STRING
+    (rb'"(\\x0[9aAdD]|' + ESCAPE_BODY + rb'|[^"\\\n\r])*"', b"STRING"),
+    (rb"[ \t\r\n]", None),
+    # INVALID_ESCAPE
+    (rb'"(' + ESCAPE_BODY + rb'|[^\\\n\r])*(\\[^\\"nrt0]|\\x|\\x[^"]|\\x[^"][^"])', "escape"),
+    # UNCLOSED_STRING
+    (rb'"(' + ESCAPE_BODY + rb'|[^\\"\n\r])*', "unclosed"),
+    (rb".", "unknown"),
+]
+RULES = [(re.compile(pattern), action) for pattern, action in RULES]
+
+
+def longest(pattern, source, start):
+    """the length of the longest match of pattern at start, or 0. No rule reaches more than three characters
+    past the end of the line it starts on, so only the ends up to there are tried"""
+    first = pattern.match(source, start)
+    if not first:
+        return 0
+    line_end = source.find(b"\n", start)
+    last = len(source) if line_end < 0 else min(len(source), line_end + 4)
+    for end in range(last, first.end(), -1):
+        if pattern.fullmatch(source, start, end):
+            return end - start
+    return first.end() - start
+
+
+def string_value(text):
+    """what hw1 prints for a STRING match: the body with its escapes decoded, up to a \\0"""
+    value = bytearray()
+    body = text[1:-1]
+    i = 0
+    while i < len(body):
+        if body[i:i + 1] != b"\\":
+            value += body[i:i + 1]
+            i += 1
+            continue
+        escape = body[i + 1:i + 2]
+        if escape == b"0":
+            break
+        if escape == b"x":
+            value.append(int(body[i + 2:i + 4], 16))
+            i += 4
+            continue
+        value += {b"t": b"\t", b"n": b"\n", b"r": b"\r"}.get(escape, escape)
+        i += 2
+    return bytes(value)
+
+
+def emulate(source):
+    """what the flex scanner of hw1 prints for source"""
+    output = []
+    line = 1
+    position = 0
+    while position < len(source):
+        length, action = max((longest(pattern, source, position), -index, action)
+                             for index, (pattern, action) in enumerate(RULES))[::2]
+        text = source[position:position + length]
+        position += length
+        line += text.count(b"\n")
+        if action == "unknown":
+            return b"".join(output) + b"ERROR: Unknown character " + text + b"\n"
+        if action == "unclosed":
+            return b"".join(output) + b"ERROR: Unclosed string\n"
+        if action == "escape":
+            return b"".join(output) + b"ERROR: Undefined escape sequence " + text[text.rindex(b"\\") + 1:] + b"\n"
+        if action == b"STRING":
+            output.append(b"%d STRING %s\n" % (line, string_value(text)))
+        elif action == b"COMMENT":
+            output.append(b"%d COMMENT //\n" % line)
+        elif action is not None:
+            output.append(b"%d %s %s\n" % (line, action, text))
+    return b"".join(output)
+
+
+ESCAPES = [b"\\n", b"\\t", b"\\r", b"\\\\", b'\\"', b"\\0", b"\\x41", b"\\x7e", b"\\x7E", b"\\x2f"]
+# Only PATTERN_OF_STRING accepts these, the other two rules take them for an invalid escape
+NEWLINE_ESCAPES = [b"\\x09", b"\\x0a", b"\\x0D"]
+# Escapes a string of hw1 does not accept, each one ending the scan
+INVALID_ESCAPES = [b"\\x7f", b"\\x1f", b"\\x00", b"\\x8", b"\\x4", b"\\x", b"\\xg", b"\\q", b"\\ ", b"\\"]
+STRAY = [b"@", b"#", b"$", b"~", b"!", b"&", b"|", b"'", b"\x7f", b"\xc3\xa9"]
+
+
+def fuzzed(rng):
+    """a source of random fragments, mostly valid. Strings take random escapes and may be left open"""
+    fragments = []
+    for _ in range(rng.randrange(1, 200)):
+        kind = rng.choices(["keyword", "punctuation", "operator", "id", "number", "string", "comment", "space",
+                            "stray"], [20, 20, 15, 20, 20, 20, 5, 30, 1])[0]
+        if kind == "keyword":
+            word = rng.choice(KEYWORDS)
+            fragments.append(word + rng.choice([b"", b"", b"1", b"x"]))
+        elif kind == "punctuation":
+            fragments.append(rng.choice(PUNCTUATION)[0])
+        elif kind == "operator":
+            fragments.append(rng.choice([b"==", b"!=", b"<", b">", b"<=", b">=", b"+", b"-", b"*", b"/", b"=<"]))
+        elif kind == "id":
+            fragments.append(rng.choice([b"a", b"Z", b"q"]) + b"%d" % rng.randrange(100))
+        elif kind == "number":
+            fragments.append(rng.choice([b"0", b"00", b"7", b"255", b"2147483647", b"01"]) +
+                             rng.choice([b"", b"", b"b", b"B", b"bb", b"x"]))
+        elif kind == "string":
+            body = b"".join(rng.choice([b"a", b"word ", b"'", b"\t"] + ESCAPES) for _ in range(rng.randrange(8)))
+            if rng.random() < 0.05:
+                body += rng.choice(NEWLINE_ESCAPES)
+            if rng.random() < 0.02:
+                body += rng.choice(INVALID_ESCAPES) + rng.choice([b"", b"a", b"1", b"\n"])
+            fragments.append(b'"' + body + rng.choice([b'"'] * 30 + [b"", b"\n", b'""']))
+            # INVALID_ESCAPE runs across quotes, so a hex escape in a later string on the line ends the scan
+            fragments.append(rng.choice([b"\n", b" "]))
+        elif kind == "comment":
+            fragments.append(b"// " + rng.choice([b"note", b'"open', b"\\q", b"@"]) + b"\n")
+        elif kind == "space":
+            fragments.append(rng.choice([b" ", b"\n", b"\t", b"\r\n", b"\r"]))
+        else:
+            fragments.append(rng.choice(STRAY))
+    return b"".join(fragments)
+
+
+def planted(source, error):
+    """source with error put at the start of the line in its middle"""
+    middle = source.index(b"\n", len(source) // 2) + 1
+    return source[:middle] + error + b"\n" + source[middle:]
+
+
+class Lexer(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.workspace = support.Workspace()
+        probe = support.run("hw1", stdin=b"")
+        cls.flex = probe.returncode == 0
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.workspace.close()
+
+    def scan(self, source, *args):
+        result = support.run("hw1", *args, stdin=source)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        return result.stdout
+
+    def test_emulation(self):
+        # The corners of the string rules, then the fuzzed inputs
+        sources = [b'"a\\x0a"', b'"\\x0a', b'"a\\q"', b'"a"\\q', b'"a\\x"', b'"a\\x1"', b'"a\\x\n', b'"a\\\n"',
+                   b'"a\\0b"', b'"a\\x7f"', b'"a', b'"a" "b\\', b"1b 0B 01 00b", b"x\n\r\ny @", b"\xc3\xa9"]
+        rng = random.Random(3)
+        sources += [fuzzed(rng) for _ in range(FUZZ)]
+        for number, source in enumerate(sources):
+            expected = emulate(source)
+            with self.subTest(number=number, source=source):
+                self.assertEqual(self.scan(source, "--lexer=simd"), expected)
+                if self.flex:
+                    self.assertEqual(self.scan(source), expected)
+
+    def test_generated_source(self):
+        source = generate.generate(50000, seed=5, mix={"id": 2, "string": 3, "comment": 1, "number": 2})[0]
+        self.assertEqual(self.scan(source.encode(), "--lexer=simd"), emulate(source.encode()))
+
+    def test_jobs(self):
+        source = generate.generate(JOBS_BYTES, seed=7)[0].encode()
+        for error in (None, b"x = @;", b'print("open);', b'print("\\q");'):
+            with self.subTest(error=error):
+                text = source if error is None else planted(source, error)
+                path = self.workspace.write("jobs.fanc", text)
+                serial = self.scan(b"", "--lexer=simd", "--input", path)
+                if error is not None:
+                    self.assertTrue(serial.endswith(b"\n") and b"\nERROR: " in serial[-200:], serial[-200:])
+                for jobs in ("2", "4"):
+                    self.assertEqual(self.scan(b"", "--jobs", jobs, "--input", path), serial)
+
+    def test_jobs_count(self):
+        # A count above the cores runs one job per core, anything but a positive number is refused
+        self.assertEqual(self.scan(b"x y\n", "--jobs", "99999999999999999999"), b"1 ID x\n1 ID y\n")
+        for count in ("0", "-1", "2x", "", " 2", "two"):
+            with self.subTest(count=count):
+                result = support.run("hw1", "--jobs", count, stdin=b"x\n")
+                self.assertEqual(result.returncode, 1)
+                self.assertIn(b"--jobs needs a positive number", result.stderr)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""Lists are built in linear time, and the parser stack stays flat however long they get.
+
+Funcs, FormalsList and ExpList are parsed with 10^6 functions and with a call of 10^5 arguments to a function of
+10^5 parameters. The default bison stack of 10,000 entries made both fail, and building the lists from the front
+made them quadratic. Each parse is also timed against one ten times smaller: a linear parse takes about ten
+times as long, a quadratic one a hundred. The bound leaves room for a noisy machine.
+
+SCALE in the environment divides the sizes for a quick run.
+"""
+
+import os
+import time
+import unittest
+
+import support
+
+SCALE = int(os.environ.get("SCALE", 1))
+FUNCTIONS = 10 ** 6 // SCALE
+ARGUMENTS = 10 ** 5 // SCALE
+# The most a parse ten times larger may take, as a multiple of the smaller one
+GROWTH = 30
+
+
+def functions(n):
+    return "".join("void f%d() { return; }\n" % i for i in range(n)) + "void main() { f0(); }\n"
+
+
+def call(n):
+    return ("int f(" + ", ".join("int a%d" % i for i in range(n)) + ") { return a0; }\n" +
+            "void main() { printi(f(" + ", ".join(str(i) for i in range(n)) + ")); }\n")
+
+
+class Scaling(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.workspace = support.Workspace()
+        cls.streams = {
+            "functions": cls.workspace.tokens(functions(FUNCTIONS), "functions"),
+            "functions/10": cls.workspace.tokens(functions(FUNCTIONS // 10), "functions10"),
+            "call": cls.workspace.tokens(call(ARGUMENTS), "call"),
+            "call/10": cls.workspace.tokens(call(ARGUMENTS // 10), "call10"),
+        }
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.workspace.close()
+
+    def run_on(self, front_end, program, *args):
+        result = support.run(front_end, "--tokens", self.streams[program], *args)
+        self.assertEqual(result.returncode, 0, result.stderr)
+        self.assertNotIn(b"error", result.stdout)
+        return result.stdout
+
+    def seconds(self, front_end, program, *args):
+        fastest = None
+        for _ in range(2):
+            start = time.perf_counter()
+            self.run_on(front_end, program, *args)
+            elapsed = time.perf_counter() - start
+            fastest = elapsed if fastest is None else min(fastest, elapsed)
+        return fastest
+
+    def test_million_functions(self):
+        dump = self.run_on("hw2", "functions", "--format=sexp")
+        self.assertEqual(dump.count(b"(FuncDecl "), FUNCTIONS + 1)
+        self.assertTrue(dump.startswith(b'(Funcs (FuncDecl (ID "f0")'))
+
+        scopes = self.run_on("hw3", "functions")
+        self.assertEqual(scopes.count(b"() -> void\n"), FUNCTIONS + 1)
+        self.assertIn(b"\nf%d () -> void\n" % (FUNCTIONS - 1), scopes)
+
+    def test_wide_call(self):
+        dump = self.run_on("hw2", "call", "--format=sexp")
+        self.assertEqual(dump.count(b"(Formal "), ARGUMENTS)
+        self.assertEqual(dump.count(b"(Num "), ARGUMENTS)
+        self.assertIn(b"(Num 0) (Num 1) (Num 2)", dump)
+
+        scopes = self.run_on("hw3", "call")
+        self.assertIn(b"\nf (" + b",".join([b"int"] * ARGUMENTS) + b") -> int\n", scopes)
+        self.assertIn(b"  a%d int -%d\n" % (ARGUMENTS - 1, ARGUMENTS), scopes)
+
+    def test_linear_time(self):
+        for front_end, args in (("hw2", ("--format=sexp",)), ("hw3", ())):
+            for program in ("functions", "call"):
+                with self.subTest(front_end=front_end, program=program):
+                    small = self.seconds(front_end, program + "/10", *args)
+                    large = self.seconds(front_end, program, *args)
+                    self.assertLess(large, GROWTH * small, (small, large))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,48 @@
+"""Helpers shared by the tests: where the binaries are, and how to run them on a source.
+
+Every test takes the build directory as its first argument. The front ends are run on the token stream hw1
+--emit-tokens=binary writes, which works whether the build has the flex scanner or not.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+BUILD = os.path.abspath(sys.argv.pop(1)) if len(sys.argv) > 1 else os.environ.get("BUILD", "_build")
+
+
+def binary(name):
+    return os.path.join(BUILD, name)
+
+
+def run(name, *args, stdin=None):
+    """runs a binary of the build and returns its completed process, with stdout and stderr as bytes"""
+    return subprocess.run([binary(name)] + list(args), input=stdin, capture_output=True)
+
+
+class Workspace:
+    """A temporary directory to write sources, token streams and AST files in"""
+
+    def __init__(self):
+        self.directory = tempfile.TemporaryDirectory()
+
+    def path(self, name):
+        return os.path.join(self.directory.name, name)
+
+    def write(self, name, data):
+        path = self.path(name)
+        with open(path, "wb") as file:
+            file.write(data if isinstance(data, bytes) else data.encode())
+        return path
+
+    def tokens(self, source, name="source"):
+        """writes source, scans it with hw1 into a token stream and returns the path of the stream"""
+        path = self.write(name + ".fanc", source)
+        stream = self.path(name + ".tok")
+        with open(stream, "wb") as file:
+            subprocess.run([binary("hw1"), "--emit-tokens=binary", "--input", path], stdout=file, check=True)
+        return stream
+
+    def close(self):
+        self.directory.cleanup()
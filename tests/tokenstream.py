@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""hw2 and hw3 refuse token streams that are cut short or corrupt, and never read past them. A stream holds the
+tokens of the PARSER dialect hw2 and hw3 scan with, so a program parses from its stream as it does from its source
+"""
+
+import random
+import unittest
+
+import support
+
+SOURCE = """int f(int a, byte b) {
+    int total = a + 200b;
+    if (total > 1000) {
+        print("big\\n");
+    }
+    return total * 3;
+}
+void main() {
+    printi(f(12, 7b));
+}
+"""
+
+
+class TokenStream(unittest.TestCase):
+    def setUp(self):
+        self.workspace = support.Workspace()
+        with open(self.workspace.tokens(SOURCE), "rb") as file:
+            self.stream = file.read()
+
+    def tearDown(self):
+        self.workspace.close()
+
+    def parse(self, front_end, stream):
+        path = self.workspace.write("case.tok", stream)
+        return support.run(front_end, "--tokens", path)
+
+    def assertRefused(self, stream):
+        for front_end in ("hw2", "hw3"):
+            result = self.parse(front_end, stream)
+            self.assertEqual(result.returncode, 1, (front_end, stream))
+            self.assertIn(b"cannot read token stream", result.stderr)
+            self.assertEqual(result.stdout, b"")
+
+    def test_whole_stream_parses(self):
+        for front_end in ("hw2", "hw3"):
+            result = self.parse(front_end, self.stream)
+            self.assertEqual(result.returncode, 0)
+            self.assertNotIn(b"error", result.stdout)
+
+    def test_lexeme_index_past_the_table(self):
+        # An ID (28) on line 1 that refers to lexeme 5 of an empty table
+        self.assertRefused(b"FCTK\x02\x1c\x00\x05")
+
+    def test_lexeme_longer_than_the_stream(self):
+        # A new lexeme of 127 bytes in a stream that ends right after its length
+        self.assertRefused(b"FCTK\x02\x1c\x00\x00\x7f")
+
+    def test_empty_number(self):
+        # A NUM whose lexeme has no digits, which used to be reported as "number  out of range"
+        self.assertRefused(b"FCTK\x02\x1d\x00\x00\x00\x00\x00\x00")
+
+    def test_string_the_parser_does_not_match(self):
+        # A STRING whose \\q escape only the LEXER dialect would have lexed, and only to report it
+        self.assertRefused(b'FCTK\x02\x1f\x00\x00\x05"a\\q"\x00\x00\x00')
+
+    def test_older_version(self):
+        # Version 1 held the tokens of the LEXER dialect
+        self.assertRefused(b"FCTK\x01" + self.stream[5:])
+
+    def test_truncated_streams(self):
+        for length in range(5, len(self.stream)):
+            self.assertRefused(self.stream[:length])
+
+    def test_corrupt_streams_never_crash(self):
+        generator = random.Random(7)
+        for _ in range(200):
+            stream = bytearray(self.stream)
+            for _ in range(generator.randrange(1, 4)):
+                stream[generator.randrange(5, len(stream))] = generator.randrange(256)
+            for front_end in ("hw2", "hw3"):
+                result = self.parse(front_end, bytes(stream))
+                # Either refused, or read and reported as a program with errors
+                self.assertIn(result.returncode, (0, 1), bytes(stream))
+
+
+    def check(self, source):
+        """what hw2 and hw3 print for source, parsed from the stream hw1 writes for it"""
+        stream = self.workspace.tokens(source, "dialect")
+        return [support.run(front_end, "--tokens", stream).stdout for front_end in ("hw2", "hw3")]
+
+    def test_backslash_after_a_string(self):
+        # The string rules of hw1 took the backslash for an escape of the string before it
+        for output in self.check('void main() {\n    print("hi"); // see C:\\dir\n}\n'):
+            self.assertNotIn(b"error", output)
+
+    def test_errors_in_source_order(self):
+        sources = [
+            ('void main() {\n    x = ;\n    print("a\\q");\n}\n', b"line 2: syntax error"),
+            ('void main() {\n    print("hi");\n    print("a\\q");\n}\n', b"line 3: lexical error"),
+            ('void main() {\n    print("");\n}\n', b"line 2: lexical error"),
+            ('void main() {\n    print("a\\x41");\n}\n', b"line 2: lexical error"),
+            ('void main() {\n    print("a\\"b");\n}\n', None),
+            # A capital B is not a suffix in this language
+            ('void main() {\n    printi(7B);\n}\n', b"line 2: syntax error"),
+        ]
+        for source, error in sources:
+            with self.subTest(source=source):
+                for output in self.check(source):
+                    if error is None:
+                        self.assertNotIn(b"error", output)
+                    else:
+                        self.assertEqual(output.splitlines()[-1], error)
+
+
+if __name__ == "__main__":
+    unittest.main()